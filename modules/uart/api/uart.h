@@ -9,9 +9,12 @@
 #include <stdlib.h> /* for size_t */
 #include <stdint.h>
 #include <xcore/port.h>
+#include <xcore/clock.h>
 #include <xcore/triggerable.h>
 #include <xcore/hwtimer.h>
 #include <xcore/interrupt.h>
+#include <xcore/channel_streaming.h>
+#include <xcore/lock.h>
 
 #include "uart_util.h"
 
@@ -49,6 +52,8 @@ typedef enum {
     UART_PARITY_ERROR       = UART_START_BIT_ERROR_VAL + 1, //Rx Only
     UART_FRAMING_ERROR      = UART_START_BIT_ERROR_VAL + 2, //Rx Only
     UART_OVERRUN_ERROR      = UART_START_BIT_ERROR_VAL + 3, //Buffered Rx only
+    UART_PACKET_ERROR       = UART_START_BIT_ERROR_VAL + 4, //Buffered Rx with framing only
+    UART_NOISE_ERROR        = UART_START_BIT_ERROR_VAL + 5, //Rx with majority vote only
 } uart_callback_code_t;
 
 /**
@@ -60,9 +65,40 @@ typedef enum {
     UART_START,
     UART_DATA,
     UART_PARITY,
-    UART_STOP
+    UART_STOP,
+    UART_AUTOBAUD,
+    UART_PAUSED
 } uart_state_t;
 
+/**
+ * Set to 1 to count frames and errors and time the ISRs of each UART Tx and
+ * Rx. It changes the size of uart_tx_t and uart_rx_t so must be set the same
+ * for the whole application. When 0 the statistics compile out.
+ */
+#ifndef UART_STATS_ENABLED
+#define UART_STATS_ENABLED 0
+#endif
+
+/**
+ * Struct holding a snapshot of the statistics of a UART Tx or Rx. Counters
+ * which do not apply to the direction stay at zero.
+ */
+typedef struct {
+    uint32_t frames;            //Frames sent or received
+    uint32_t start_bit_errors;  //Rx only
+    uint32_t parity_errors;     //Rx only
+    uint32_t framing_errors;    //Rx only
+    uint32_t noise_errors;      //Rx only, frames with a noisy bit corrected by majority vote
+    uint32_t overruns;          //Bytes dropped as the buffer was full
+    uint32_t underruns;         //Rx only. uart_rx() called with the buffer empty
+    uint32_t buffer_high_water; //Highest buffer fill level seen
+    uint32_t isr_count;         //Number of ISRs timed
+    uint32_t isr_ticks_min;     //Shortest ISR in reference clock ticks
+    uint32_t isr_ticks_max;     //Longest ISR in reference clock ticks
+    uint32_t isr_ticks_mean;    //Mean ISR in reference clock ticks
+    uint64_t isr_ticks_total;   //Total ISR time in reference clock ticks
+} uart_stats_t;
+
 
 /**
  * This attribute must be specified on the UART TX UNDERRUN callback function
@@ -88,8 +124,14 @@ typedef enum {
 typedef struct {
     uart_state_t state;
     port_t tx_port;
+    xclock_t clk;
     uint32_t bit_time_ticks;
+    uint32_t bit_time_frac; //16b fraction of a tick
+    uint32_t bit_time_acc;
     uint32_t next_event_time_ticks;
+    uint32_t port_timed; //Bits are sent with timed port outputs, one bit ahead of the state machine
+    uint32_t port_time_ticks; //Port time of the last bit sent
+    uint32_t port_time_valid; //Zero when the next start bit must be timed from the port again
     uart_parity_t parity;
     uint8_t num_data_bits;
     uint8_t current_data_bit;
@@ -98,9 +140,27 @@ typedef struct {
     uint8_t current_stop_bit;
 
     HIL_UART_TX_CALLBACK_ATTR void(*uart_tx_empty_callback_fptr)(void* app_data);
+    HIL_UART_TX_CALLBACK_ATTR void(*uart_tx_low_watermark_callback_fptr)(void* app_data);
+    uint32_t low_watermark; //Zero means disabled
+    port_t cts_port; //Zero means no flow control
+    port_t de_port; //Zero means not RS-485
+    uint32_t de_lead_ticks;
+    uint32_t de_asserted;
+    uint32_t de_time_offset; //Reference time minus DE port time
+    streaming_channel_t space_chan; //ISR to uart_tx_wait() wakeup, allocated on first wait
+    uint32_t space_waiter; //Non-zero when uart_tx_wait() is waiting for space
+    lock_t producer_lock; //Zero means single producer
+    unsigned claim_idx; //Multi-producer: end of the space claimed so far, ahead of buffer.write_idx
+    streaming_channel_t kick_chan; //Multi-producer: asks the ISR to start from idle
+    uint32_t kick_pending;
+    uart_crc_t crc; //Running CRC of words queued since the last CRC was sent
+    uint32_t specialised; //Set by UART_TX_DEFINE(), whose state machine has no runtime features
+#if UART_STATS_ENABLED
+    uart_stats_t stats;
+#endif
     void *app_data;
     hwtimer_t tmr;
-    uart_buffer_t buffer;
+    uart_ring_t buffer;
 } uart_tx_t;
 
 
@@ -120,9 +180,11 @@ typedef struct {
  *                      UART will run in blocking mode. If initialised to a
  *                      valid buffer, the UART will be interrupt driven.
  * \param buffer_size_plus_one   Size of the buffer if enabled in tx_buff. 
- *                      Note that the buffer allocation and size argument
- *                      must be one greater than needed. Eg. buff[65] for a
- *                      64 byte buffer.
+ *                      The buffer holds the largest power of two bytes that
+ *                      fits, so buff[65] gives a 64 byte buffer as before.
+ *                      Other sizes now hold fewer bytes than in earlier
+ *                      versions, eg. buff[100] holds 64 rather than 99, so
+ *                      size buffers as a power of two plus one.
  * \param uart_tx_empty_callback_fptr Callback function pointer for UART buffer 
  *                      empty in buffered mode.
  * \param app_data      A pointer to application specific data provided
@@ -169,9 +231,64 @@ void uart_tx_blocking_init(
         hwtimer_t tmr);
 
 
+/**
+ * Initializes a clocked UART Tx I/O interface. A clock block divides the
+ * reference clock down to the bit rate and whole frames (start, data, parity
+ * and stop bits) are written to a 32b buffered port in one go. In buffered
+ * mode this means one interrupt per frame rather than one per bit.
+ *
+ * Since the bit clock is derived from the 100MHz reference clock by an
+ * integer divider, the supported baud rates are between 196079 and 50000000.
+ * The achieved rate is the nearest of 50MHz / n.
+ *
+ * \param uart          The uart_tx_t context to initialise.
+ * \param tx_port       The 1b port used transmit the UART frames.
+ * \param clk           The clock block used to clock the port. It is
+ *                      enabled by this function.
+ * \param baud_rate     The baud rate of the UART in bits per second.
+ * \param data_bits     The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param tmr           The resource id of the timer to be used. Only needed
+ *                      in buffered mode, may be set to 0 otherwise.
+ * \param tx_buff       Pointer to a buffer. Optional. If set to zero the 
+ *                      UART will run in blocking mode. If initialised to a
+ *                      valid buffer, the UART will be interrupt driven.
+ * \param buffer_size_plus_one   Size of the buffer if enabled in tx_buff. 
+ *                      The buffer holds the largest power of two bytes that
+ *                      fits, so buff[65] gives a 64 byte buffer as before.
+ *                      Other sizes now hold fewer bytes than in earlier
+ *                      versions, eg. buff[100] holds 64 rather than 99, so
+ *                      size buffers as a power of two plus one.
+ * \param uart_tx_empty_callback_fptr Callback function pointer for UART buffer 
+ *                      empty in buffered mode.
+ * \param app_data      A pointer to application specific data provided
+ *                      by the application. Used to share data between
+ *                      this callback function and the application.
+ */
+void uart_tx_clocked_init(
+        uart_tx_t *uart,
+        port_t tx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        hwtimer_t tmr,
+        uint8_t *tx_buff,
+        size_t buffer_size_plus_one,
+        void(*uart_tx_empty_callback_fptr)(void* app_data),
+        void *app_data
+        );
+
+
 /**
  * Transmits a single UART frame with parameters as specified in uart_tx_init()
  *
+ * In buffered mode the word is dropped if the buffer is full. Use uart_tx_try()
+ * or uart_tx_wait() where the producer may outrun the line.
+ *
  * \param uart          The uart_tx_t context to initialise.
  * \param data          The word to transmit.
  */
@@ -179,9 +296,223 @@ void uart_tx(
         uart_tx_t *uart,
         uint8_t data);
 
+/**
+ * Queues a single UART frame for transmit in buffered mode without blocking.
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param data          The word to transmit.
+ *
+ * \return              UART_BUFFER_OK if the word was queued or UART_BUFFER_FULL
+ *                      if there was no space, in which case nothing is queued.
+ */
+uart_buffer_error_t uart_tx_try(
+        uart_tx_t *uart,
+        uint8_t data);
+
+/**
+ * Queues a single UART frame for transmit in buffered mode, waiting for space
+ * in the buffer if it is full. The wait is an event on a channel end which the
+ * Tx ISR signals as soon as it takes a word from the buffer, so the thread
+ * uses no cycles while waiting and the buffer is refilled the moment there is
+ * space. It may be called from the thread running the Tx ISR.
+ *
+ * A streaming channel is allocated on the first wait and freed by
+ * uart_tx_deinit(). Only one thread may wait on a UART Tx at a time.
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param data          The word to transmit.
+ */
+void uart_tx_wait(
+        uart_tx_t *uart,
+        uint8_t data);
+
+/**
+ * Transmits a block of UART frames with parameters as specified in uart_tx_init().
+ * In buffered mode the data is copied into the buffer in one go and the
+ * transmit is started at most once per call. It does not block, so only as
+ * many bytes as there is space for in the buffer are taken. In blocking mode
+ * all bytes are sent before returning.
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param data          Pointer to the words to transmit.
+ * \param n             The number of words to transmit.
+ *
+ * \return              The number of words sent or queued.
+ */
+size_t uart_tx_write(
+        uart_tx_t *uart,
+        const uint8_t *data,
+        size_t n);
+
+/**
+ * Gets space in the Tx buffer to write frames into directly, avoiding a copy.
+ * Buffered mode only. The frames are sent once passed to uart_tx_commit().
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param n             The maximum number of words wanted.
+ * \param len           Pointer to where the number of words of contiguous
+ *                      space at the returned pointer is stored. This may be
+ *                      less than n where the buffer wraps, or 0 if it is full.
+ *
+ * \return              Pointer to the space in the buffer.
+ */
+uint8_t *uart_tx_reserve(
+        uart_tx_t *uart,
+        size_t n,
+        size_t *len);
+
+/**
+ * Queues words written into space from uart_tx_reserve() for transmit, starting
+ * the transmit if it is idle.
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param n             The number of words written. At most the len returned
+ *                      by uart_tx_reserve().
+ */
+void uart_tx_commit(
+        uart_tx_t *uart,
+        size_t n);
+
+/**
+ * Allows a buffered UART Tx to be shared by several producer threads, which
+ * then queue whole messages with uart_tx_write_message(). Each producer claims
+ * space for its message under the hardware lock, then copies the message in
+ * without holding it, so producers are only serialised for the claim. The ISR
+ * only sees messages once they and all messages claimed before them have been
+ * copied in, so messages are sent whole and in the order they were claimed.
+ *
+ * Producers may run on any thread, so they cannot start the Tx ISR directly.
+ * Instead a streaming channel is allocated which the producer uses to ask the
+ * ISR to start when the Tx is idle. This must be called from the thread that
+ * called uart_tx_init(), which runs the ISR. After this only
+ * uart_tx_write_message() may be used to queue data. Not supported in clocked
+ * mode.
+ *
+ * \param uart          The uart_tx_t context.
+ * \param lock          A hardware lock, from lock_alloc(), used for claiming space.
+ */
+void uart_tx_set_multi_producer(
+        uart_tx_t *uart,
+        lock_t lock);
+
+/**
+ * Queues a whole message on a buffered UART Tx shared by several producers.
+ * The message is queued in full or not at all. May be called from any thread.
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ * \param data          Pointer to the message.
+ * \param n             The number of words in the message.
+ *
+ * \return              UART_BUFFER_OK if the message was queued or
+ *                      UART_BUFFER_FULL if there was not enough space for it.
+ */
+uart_buffer_error_t uart_tx_write_message(
+        uart_tx_t *uart,
+        const uint8_t *data,
+        size_t n);
+
+/**
+ * Enables a running CRC on a UART Tx. The CRC is updated with each word as it
+ * is queued by uart_tx(), uart_tx_try(), uart_tx_wait(), uart_tx_write() or
+ * uart_tx_commit(), so a packet's CRC is ready as soon as its last byte is
+ * queued with no second pass over the data. It is then sent with
+ * uart_tx_send_crc(). Words are masked to the data bits before the update, so
+ * the CRC covers what is on the wire. Not supported with
+ * uart_tx_set_multi_producer().
+ *
+ * \param uart          The uart_tx_t context.
+ * \param crc           The CRC, set up with uart_crc_init() or
+ *                      uart_crc_init_preset(). It is copied. NULL disables.
+ */
+void uart_tx_set_crc(
+        uart_tx_t *uart,
+        const uart_crc_t *crc);
+
+/**
+ * Sends the CRC of the words queued since the last call, or since the CRC was
+ * enabled, and starts the CRC again for the next packet. The CRC is sent LSB
+ * first for reflected CRCs and MSB first otherwise. In buffered mode this
+ * waits for space as uart_tx_wait().
+ *
+ * \param uart          The uart_tx_t context to transmit on.
+ */
+void uart_tx_send_crc(uart_tx_t *uart);
+
+/**
+ * Sets a low watermark on the buffer of a buffered UART Tx. The callback is
+ * called from ISR context each time the number of words waiting in the buffer
+ * falls below the watermark, so a producer can refill the buffer before it
+ * empties and the line goes idle.
+ *
+ * \param uart          The uart_tx_t context.
+ * \param low_watermark The fill level below which the callback is called.
+ *                      Zero disables the watermark.
+ * \param uart_tx_low_watermark_callback_fptr Callback function pointer for
+ *                      the buffer falling below the watermark.
+ */
+void uart_tx_set_low_watermark(
+        uart_tx_t *uart,
+        uint32_t low_watermark,
+        void(*uart_tx_low_watermark_callback_fptr)(void* app_data));
+
+/**
+ * Enables CTS flow control on a buffered UART Tx initialised with uart_tx_init()
+ * or on a blocking UART Tx. CTS is active low. When CTS is deasserted (high)
+ * the Tx pauses at the next frame boundary, and resumes when CTS is asserted
+ * again using a port event so no polling is needed.
+ *
+ * \param uart          The uart_tx_t context.
+ * \param cts_port      The 1b port connected to CTS. It is enabled by this call.
+ */
+void uart_tx_set_cts(
+        uart_tx_t *uart,
+        port_t cts_port);
+
+/**
+ * Enables RS-485 half duplex mode on a UART Tx initialised with uart_tx_init()
+ * or uart_tx_blocking_init(). The driver enable (DE) port is driven high the
+ * given time before the start bit of the first frame, stays high across back to
+ * back frames, and is driven low at the end of the last stop bit. At 3052 baud
+ * and above the release is an exact timed port output, and below it is driven
+ * from the timer at the end of the stop bit. This keeps bus turnaround well
+ * inside one bit time without the application polling for the end of transmit.
+ *
+ * \param uart          The uart_tx_t context.
+ * \param de_port       The 1b port connected to the RS-485 driver enable. It
+ *                      is enabled and driven low by this call.
+ * \param lead_ticks    The time in 100MHz reference clock ticks DE is asserted
+ *                      before the start bit. Must be less than 0x8000 at 3052
+ *                      baud and above, where the start bit is scheduled on the
+ *                      16 bit port timer.
+ */
+void uart_tx_set_rs485(
+        uart_tx_t *uart,
+        port_t de_port,
+        uint32_t lead_ticks);
+
+/**
+ * Takes a consistent snapshot of the statistics of a UART Tx. Needs
+ * UART_STATS_ENABLED, otherwise the snapshot is all zero.
+ *
+ * \param uart          The uart_tx_t context.
+ * \param stats         Filled in with the statistics.
+ */
+void uart_tx_get_stats(
+        uart_tx_t *uart,
+        uart_stats_t *stats);
+
+/**
+ * Clears the statistics of a UART Tx, eg. after each telemetry snapshot.
+ *
+ * \param uart          The uart_tx_t context.
+ */
+void uart_tx_reset_stats(
+        uart_tx_t *uart);
+
 /**
  * De-initializes the specified UART Tx interface. This disables the
- * port also. The timer, if used, needs to be freed by the application.
+ * port also, and the clock block when in clocked mode. The timer, if used,
+ * needs to be freed by the application.
  *
  * \param uart          The uart_tx_t context to de-initialise.
  */
@@ -199,6 +530,15 @@ void uart_tx_deinit(
  * @{
  */
 
+/**
+ * Enum type representing how a baud rate detected by autobaud is applied.
+ */
+typedef enum {
+    UART_AUTOBAUD_OFF = 0,  //Autobaud disabled
+    UART_AUTOBAUD_SNAP,     //Use the nearest standard baud rate
+    UART_AUTOBAUD_MEASURED  //Use the measured bit time as is
+} uart_autobaud_mode_t;
+
 /**
  * Struct to hold a UART Rx context.
  *
@@ -208,21 +548,71 @@ void uart_tx_deinit(
 typedef struct {
     uart_state_t state;
     port_t rx_port;
+    xclock_t clk;
     uint32_t bit_time_ticks;
-    uint32_t next_event_time_ticks;
+    uint32_t bit_time_frac; //16b fraction of a tick
+    uint32_t bit_time_acc;
+    uint32_t next_event_time_ticks; //Port time of the next sample when port timed
+    uint32_t port_timed; //Samples are timed from the start edge on the port timer
     uart_parity_t parity;
     uint8_t num_data_bits;
     uint8_t current_data_bit;
-    uint8_t uart_data;
+    uint16_t uart_data; //9b in multidrop mode
     uint8_t stop_bits;
     uint8_t current_stop_bit;
 
+    //Oversampled mode only. Positions are in samples (16.16) from the start of the older word
+    uint32_t samples_per_bit_q16;
+    uint32_t sample_pos_q16;
+    uint32_t search_from;
+    uint32_t samples[2];
+
+    //Idle line detection. Zero timeout means disabled
+    uint32_t idle_timeout_ticks;
+    uint32_t idle_byte_count;
+
+    //Autobaud. Edge time is in port timer ticks
+    uart_autobaud_mode_t autobaud_mode;
+    uint16_t autobaud_edge_time;
+
     uart_callback_code_t cb_code;
     HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_complete_callback_arg)(void* app_data);
     HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_error_callback_arg)(uart_callback_code_t callback_code, void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_idle_callback_arg)(size_t num_bytes, void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_high_watermark_callback_arg)(void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_autobaud_callback_arg)(uint32_t baud_rate, void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR uint8_t *(*uart_rx_packet_callback_arg)(uint8_t *packet, size_t len, void* app_data);
+    uint32_t high_watermark; //Zero means disabled
+    port_t rts_port; //Zero means no flow control
+    uint32_t rts_high_watermark;
+    uint32_t rts_low_watermark;
+    uint32_t rts_deasserted;
+
+    //Multidrop. The 9th data bit marks an address frame
+    uint32_t multidrop;
+    uint32_t multidrop_address;
+    uint32_t multidrop_mask;
+    uint32_t multidrop_selected;
+    uint32_t multidrop_frame_ok;
+    uint8_t *multidrop_marks; //Indexed as the buffer, non-zero for address frames. NULL means not kept
+    uart_deframer_t deframer; //UART_FRAMING_NONE means bytes go to the buffer
+    uint32_t *timestamps; //Indexed as the buffer. NULL means disabled
+    uint32_t edge_time_ticks; //Reference time of the falling edge of the current start bit
+    uint32_t port_time_offset; //Reference time minus Rx port time
+    uint32_t vote_ticks; //Majority vote sample spacing. Zero means one sample per bit
+    uint32_t noise_detected; //A sample disagreed with the vote in the current frame
+    chanend_t stream_chanend; //Zero means bytes go to the buffer
+    uint32_t stream_word; //Bytes not yet streamed, first received at the bottom
+    uint32_t stream_count;
+    uart_crc_t crc; //Running CRC of the current packet. Width zero means disabled
+    uint32_t packet_crc; //CRC of the last packet
+    uint32_t specialised; //Set by UART_RX_DEFINE(), whose state machine has no runtime features
+#if UART_STATS_ENABLED
+    uart_stats_t stats;
+#endif
     void *app_data;
     hwtimer_t tmr;
-    uart_buffer_t buffer;
+    uart_ring_t buffer;
 } uart_rx_t;
 
 
@@ -242,9 +632,11 @@ typedef struct {
  *                      UART will run in blocking mode. If initialised to a
  *                      valid buffer, the UART will be interrupt driven.
  * \param buffer_size_plus_one   Size of the buffer if enabled in rx_buff. 
- *                      Note that the buffer allocation and size argument
- *                      must be one greater than needed. Eg. buff[65] for a
- *                      64 byte buffer. 
+ *                      The buffer holds the largest power of two bytes that
+ *                      fits, so buff[65] gives a 64 byte buffer as before.
+ *                      Other sizes now hold fewer bytes than in earlier
+ *                      versions, eg. buff[100] holds 64 rather than 99, so
+ *                      size buffers as a power of two plus one.
  * \param uart_rx_complete_callback_fptr Callback function pointer for UART rx
  *                      complete (one word) in buffered mode only. Optionally NULL.
  * \param uart_rx_error_callback_fptr Callback function pointer for UART rx errors 
@@ -300,6 +692,99 @@ void uart_rx_blocking_init(
         void *app_data
         );
 
+/**
+ * Initializes a UART Rx I/O interface driven by events on the Rx port, so that
+ * one thread may wait on several UARTs, channels and timers together. The port
+ * is armed for the next start bit but no event vector is set up and the
+ * trigger is not enabled. The application sets up the vector on the port with
+ * TRIGGERABLE_SETUP_EVENT_VECTOR(), enables it and calls
+ * uart_rx_service_event() each time the port event fires.
+ *
+ * All events, start bit and samples, come from the Rx port so no timer is
+ * needed, but the bit time must be under half the 16b port timer wrap, ie.
+ * 3052 baud or above. Each event must be serviced within a bit time.
+ *
+ * \param uart          The uart_rx_t context to initialise.
+ * \param rx_port       The port used receive the UART frames.
+ * \param baud_rate     The baud rate of the UART in bits per second.
+ * \param data_bits     The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param uart_rx_error_callback_fptr Callback function pointer for UART rx errors
+ *                      The error is contained in cb_code in the uart_rx_t struct.
+ * \param app_data      A pointer to application specific data provided
+ *                      by the application. Used to share data between
+ *                      the error callback function and the application.
+ */
+void uart_rx_event_init(
+        uart_rx_t *uart,
+        port_t rx_port,
+        uint32_t baud_rate,
+        uint8_t data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        );
+
+/**
+ * Initializes an oversampled UART Rx I/O interface. The Rx line is sampled at
+ * oversample times the baud rate into a 32b buffered port clocked from a clock
+ * block and frames are extracted a word of samples at a time. Each bit is
+ * decided by a majority vote of the three samples around its centre. In
+ * buffered mode the port interrupts once per 32 samples rather than once per
+ * bit so the ISR load does not scale with the number of bits.
+ *
+ * The sample clock is divided down from the 100MHz reference clock so it may
+ * not be an exact multiple of the baud rate. The sampling points are tracked
+ * with a fractional accumulator so this does not matter as long as there are
+ * at least oversample samples per bit. A glitch that is not followed by a
+ * valid start bit raises UART_START_BIT_ERROR and the receiver goes back to
+ * looking for a start bit.
+ *
+ * \param uart          The uart_rx_t context to initialise.
+ * \param rx_port       The 1b port used receive the UART frames.
+ * \param clk           The clock block used to clock the port. It is
+ *                      enabled by this function.
+ * \param baud_rate     The baud rate of the UART in bits per second.
+ * \param oversample    The number of samples per bit. 4, 8 or 16.
+ * \param data_bits     The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param rx_buff       Pointer to a buffer. Optional. If set to zero the 
+ *                      UART will run in blocking mode. If initialised to a
+ *                      valid buffer, the UART will be interrupt driven.
+ * \param buffer_size_plus_one   Size of the buffer if enabled in rx_buff. 
+ *                      The buffer holds the largest power of two bytes that
+ *                      fits, so buff[65] gives a 64 byte buffer as before.
+ *                      Other sizes now hold fewer bytes than in earlier
+ *                      versions, eg. buff[100] holds 64 rather than 99, so
+ *                      size buffers as a power of two plus one.
+ * \param uart_rx_complete_callback_fptr Callback function pointer for UART rx
+ *                      complete (one word) in buffered mode only. Optionally NULL.
+ * \param uart_rx_error_callback_fptr Callback function pointer for UART rx errors 
+ *                      The error is contained in cb_code in the uart_rx_t struct.
+ * \param app_data      A pointer to application specific data provided
+ *                      by the application. Used to share data between
+ *                      this callback function and the application.
+ */
+void uart_rx_oversampled_init(
+        uart_rx_t *uart,
+        port_t rx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t oversample,
+        uint8_t data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *rx_buff,
+        size_t buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        );
+
 /**
  * Receives a single UART frame with parameters as specified in uart_rx_init()
  *
@@ -310,9 +795,373 @@ void uart_rx_blocking_init(
  */
 uint8_t uart_rx(uart_rx_t *uart);
 
+/**
+ * Receives a single UART frame from a buffered UART Rx along with its timestamp.
+ * Timestamps must have been enabled with uart_rx_set_timestamps().
+ *
+ * \param uart          The uart_rx_t context to receive from.
+ * \param timestamp     Pointer to where the reference time of the falling edge
+ *                      of the start bit of the word is stored.
+ *
+ * \return              The oldest received word.
+ */
+uint8_t uart_rx_timestamped(uart_rx_t *uart, uint32_t *timestamp);
+
+/**
+ * Runs one step of a UART Rx set up with uart_rx_event_init(). Call this when
+ * the Rx port event fires. It handles the start bit edge or one bit sample and
+ * re-arms the port for the next event.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param data          Set to the frame received when one completes.
+ *
+ * \return              Non-zero when a frame has been received into data. In
+ *                      multidrop mode this is 2 for an address frame.
+ */
+int uart_rx_service_event(uart_rx_t *uart, uint8_t *data);
+
+/**
+ * Receives a block of UART frames with parameters as specified in uart_rx_init().
+ * In buffered mode this copies out up to n of the oldest received words in one
+ * go and does not block. Unlike uart_rx(), running out of data is not reported
+ * to the error callback. In blocking mode it waits for all n words.
+ *
+ * \param uart          The uart_rx_t context to receive from.
+ * \param data          Pointer to where the received words are stored.
+ * \param n             The maximum number of words to receive.
+ * \param got           Pointer to where the number of words received is stored.
+ *
+ * \return              UART_BUFFER_OK if n words were received, otherwise
+ *                      UART_BUFFER_EMPTY.
+ */
+uart_buffer_error_t uart_rx_read(
+        uart_rx_t *uart,
+        uint8_t *data,
+        size_t n,
+        size_t *got);
+
+/**
+ * Gets the oldest received words in the Rx buffer to read in place, avoiding
+ * a copy. Buffered mode only. The words stay in the buffer until passed to
+ * uart_rx_release().
+ *
+ * \param uart          The uart_rx_t context to receive from.
+ * \param n             The maximum number of words wanted.
+ * \param len           Pointer to where the number of contiguous words at the
+ *                      returned pointer is stored. This may be less than n
+ *                      where the buffer wraps, or 0 if it is empty.
+ *
+ * \return              Pointer to the oldest received word.
+ */
+const uint8_t *uart_rx_peek(
+        uart_rx_t *uart,
+        size_t n,
+        size_t *len);
+
+/**
+ * Removes words read via uart_rx_peek() from the Rx buffer.
+ *
+ * \param uart          The uart_rx_t context to receive from.
+ * \param n             The number of words to remove. At most the len
+ *                      returned by uart_rx_peek().
+ */
+void uart_rx_release(
+        uart_rx_t *uart,
+        size_t n);
+
+/**
+ * Enables idle line detection on a buffered UART Rx initialised with
+ * uart_rx_init(). Once the line has been idle for the given number of bit
+ * times after a stop bit, the idle callback is called once with the number of
+ * words received since the line was last idle. This allows a consumer to be
+ * woken once per packet rather than once per word, in which case the complete
+ * callback may be NULL. The idle callback is called from ISR context.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param idle_bits     The number of bit times of idle line which end a
+ *                      packet. Zero disables idle line detection.
+ * \param uart_rx_idle_callback_fptr Callback function pointer for the idle
+ *                      line after a packet.
+ */
+void uart_rx_set_idle_timeout(
+        uart_rx_t *uart,
+        uint32_t idle_bits,
+        void(*uart_rx_idle_callback_fptr)(size_t num_bytes, void *app_data));
+
+/**
+ * Sets a high watermark on the buffer of a buffered UART Rx. The callback is
+ * called from ISR context each time the number of words waiting in the buffer
+ * reaches the watermark, so a consumer can drain the buffer in batches
+ * rather than after each word.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param high_watermark The fill level at which the callback is called.
+ *                      Zero disables the watermark.
+ * \param uart_rx_high_watermark_callback_fptr Callback function pointer for
+ *                      the buffer reaching the watermark.
+ */
+void uart_rx_set_high_watermark(
+        uart_rx_t *uart,
+        uint32_t high_watermark,
+        void(*uart_rx_high_watermark_callback_fptr)(void* app_data));
+
+/**
+ * Arms automatic baud rate detection on a UART Rx initialised with
+ * uart_rx_init() or uart_rx_blocking_init(). The width of the next start bit
+ * is timed edge to edge using port timestamps and the bit time is set from it
+ * before the rest of the frame is received as normal. This needs the first data
+ * bit to be a 1, as in the sync characters 0x55 ('U') and 0x7F, or 'A' or 'a'.
+ * Detection happens once per call; call again to re-detect, eg. after errors.
+ * The start bit is timed on the 16 bit port timer so the slowest rate which can
+ * be detected is about 1526 baud (XS1_TIMER_HZ / 0xffff); slower start bits wrap
+ * and are measured short. UART_AUTOBAUD_SNAP chooses from 2400 to 2000000 baud.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param mode          How the measured rate is applied. See uart_autobaud_mode_t.
+ *                      UART_AUTOBAUD_OFF cancels a pending detection.
+ * \param uart_rx_autobaud_callback_fptr Callback function pointer called with
+ *                      the baud rate in use once detected. Optionally NULL.
+ *                      Called from ISR context in buffered mode.
+ */
+void uart_rx_set_autobaud(
+        uart_rx_t *uart,
+        uart_autobaud_mode_t mode,
+        void(*uart_rx_autobaud_callback_fptr)(uint32_t baud_rate, void *app_data));
+
+/**
+ * Enables RTS flow control on a buffered UART Rx initialised with uart_rx_init()
+ * or uart_rx_oversampled_init(). RTS is active low and is asserted by this call.
+ * It is deasserted from the ISR once the buffer fill level reaches the high
+ * watermark, and asserted again when the application has read the buffer down
+ * to the low watermark. The high watermark should leave room in the buffer for
+ * the far end to stop sending.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param rts_port      The 1b port connected to RTS. It is enabled by this call.
+ * \param high_watermark The fill level at which RTS is deasserted.
+ * \param low_watermark The fill level at or below which RTS is asserted again.
+ */
+void uart_rx_set_rts(
+        uart_rx_t *uart,
+        port_t rts_port,
+        uint32_t high_watermark,
+        uint32_t low_watermark);
+
+/**
+ * Enables 9 bit multidrop mode on a UART Rx initialised with 8 data bits and
+ * no parity. Each frame then carries a 9th data bit which is set for address
+ * frames. When an address frame matches the node address under the mask, it
+ * and the data frames following it are received. Frames following any other
+ * address are dropped in the Rx state machine before they reach the buffer or
+ * any callback, so traffic for other nodes does not wake the application.
+ * The matching address frame is received like a data frame so the start of
+ * each packet can be seen, and uart_rx_multidrop() returns it with the 9th bit
+ * set. The buffer only holds 8 bits per word, so in buffered mode the 9th bit
+ * of each word is kept in the marks array. Without it address and data frames
+ * read the same from the buffer.
+ *
+ * May not be used with a UART Rx from UART_RX_DEFINE().
+ *
+ * \param uart          The uart_rx_t context.
+ * \param address       The node address.
+ * \param mask          The bits of the address frame compared with address.
+ *                      Eg. 0xff for an exact match or 0xf0 for a group.
+ * \param marks         Buffered mode only. Array for the 9th bit of each word
+ *                      in the buffer, or NULL to not keep it.
+ * \param num_marks     The number of entries in marks. At least the
+ *                      buffer_size_plus_one passed to uart_rx_init().
+ */
+void uart_rx_set_multidrop(
+        uart_rx_t *uart,
+        uint8_t address,
+        uint8_t mask,
+        uint8_t *marks,
+        size_t num_marks);
+
+/**
+ * Receives a single 9 bit frame from a UART Rx in multidrop mode. Bit 8 is set
+ * for address frames. Buffered mode needs the marks array passed to
+ * uart_rx_set_multidrop().
+ *
+ * \param uart          The uart_rx_t context to receive from.
+ *
+ * \return              The frame received, with the address mark in bit 8. In
+ *                      buffered mode it gets the oldest received word.
+ */
+uint16_t uart_rx_multidrop(uart_rx_t *uart);
+
+/**
+ * The minimum majority vote sample spacing. The second sample must still be
+ * in the future once the first has been handled.
+ */
+#define UART_RX_VOTE_MIN_TICKS (XS1_TIMER_MHZ * 1)
+
+/**
+ * Enables majority vote sampling in a UART Rx. Each bit is sampled three times,
+ * spacing_ticks apart and centred on the middle of the bit, and the bit is taken
+ * as the value of at least two of the samples so a short glitch on the line
+ * does not corrupt the word. The later samples are timed port inputs taken
+ * while handling the first, so there are no more events per bit, but handling
+ * each bit takes around 2 * spacing_ticks longer.
+ *
+ * Frames where any sample disagreed with the vote are still received, and are
+ * reported to the error callback as UART_NOISE_ERROR.
+ *
+ * Requires a port timed UART Rx, so bit times below 0x8000 ticks, and may not
+ * be used with autobaud or oversampled mode.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param spacing_ticks The reference clock ticks between samples, at least
+ *                      UART_RX_VOTE_MIN_TICKS and at most a quarter of a bit
+ *                      time. Zero takes a single sample per bit.
+ */
+void uart_rx_set_majority_vote(
+        uart_rx_t *uart,
+        uint32_t spacing_ticks);
+
+/**
+ * Enables per word timestamps in a buffered UART Rx initialised with uart_rx_init().
+ * The ISR stores the reference time of the falling edge of each start bit
+ * alongside the word in the buffer, taken from the port timestamp of the edge
+ * where the bit time allows, so the timestamps do not include ISR latency.
+ * Timestamps are read with uart_rx_timestamped().
+ *
+ * This allows inter character gaps, such as the Modbus RTU t3.5 end of frame,
+ * to be measured from the received data without polling.
+ *
+ * Should be called before data starts to arrive. Not supported in oversampled
+ * mode or with uart_rx_set_framing().
+ *
+ * \param uart          The uart_rx_t context.
+ * \param timestamps    Array for the timestamps, or NULL to disable.
+ * \param num_timestamps The number of entries in the array. At least the
+ *                      buffer_size_plus_one passed to uart_rx_init().
+ */
+void uart_rx_set_timestamps(
+        uart_rx_t *uart,
+        uint32_t *timestamps,
+        size_t num_timestamps);
+
+/**
+ * Enables SLIP or COBS packet decoding in a buffered UART Rx. Received bytes
+ * are decoded by the ISR straight into the packet buffer instead of going to
+ * the Rx buffer, and each complete packet is passed to the packet callback.
+ * The per byte complete callback is not called. Packets which are badly
+ * encoded or do not fit are dropped and reported to the error callback as
+ * UART_PACKET_ERROR.
+ *
+ * The packet callback runs in the ISR and returns the buffer to decode the next
+ * packet into. Returning the same buffer means the packet must be dealt with
+ * before returning, while returning another buffer of the same size allows the
+ * packet to be handed to a thread without copying it.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param framing       The packet framing, or UART_FRAMING_NONE to disable.
+ * \param packet        The buffer the first packet is decoded into.
+ * \param packet_size   The size of each packet buffer.
+ * \param uart_rx_packet_callback_fptr Callback function pointer called with each
+ *                      decoded packet and its length.
+ */
+void uart_rx_set_framing(
+        uart_rx_t *uart,
+        uart_framing_t framing,
+        uint8_t *packet,
+        size_t packet_size,
+        uint8_t *(*uart_rx_packet_callback_fptr)(uint8_t *packet, size_t len, void *app_data));
+
+/**
+ * Streams received words out of a buffered UART Rx ISR over a streaming
+ * channel instead of storing them in the Rx buffer, so a consumer on another
+ * tile can receive them without a relay thread. Words are sent four at a time
+ * as one channel word. The per word complete callback is not called.
+ *
+ * A partial word is sent when the line goes idle if idle line detection is
+ * enabled with uart_rx_set_idle_timeout(), which may then be given a NULL idle
+ * callback. The partial word is sent as individual bytes followed by an END
+ * control token, and an END alone is sent if the burst ended on a whole word,
+ * so the consumer sees the end of each burst. Words are received at the other
+ * end with uart_rx_stream_in().
+ *
+ * The ISR blocks if the channel is full, so the consumer must keep up with
+ * the line. Not supported with uart_rx_set_framing() or uart_rx_set_timestamps().
+ *
+ * \param uart          The uart_rx_t context.
+ * \param c             The chanend to stream from, one end of a streaming
+ *                      channel to the consumer. Zero ends the burst as for
+ *                      the idle line and returns to using the Rx buffer.
+ */
+void uart_rx_set_streaming(
+        uart_rx_t *uart,
+        chanend_t c);
+
+/**
+ * Receives from a UART Rx streaming with uart_rx_set_streaming(). This is
+ * called by the consumer, on any tile, with the other end of the channel and
+ * blocks until a whole word or the end of a burst is received.
+ *
+ * \param c             The consumer end of the streaming channel.
+ * \param data          Array of at least 4 where the received words are stored,
+ *                      oldest first.
+ *
+ * \return              The number of words received. 4 for a whole word, or
+ *                      0 to 3 at the end of a burst.
+ */
+size_t uart_rx_stream_in(
+        chanend_t c,
+        uint8_t *data);
+
+/**
+ * Enables a running CRC on a buffered UART Rx. The ISR updates the CRC with
+ * each word as it is received, and at the end of each packet the result is
+ * latched for uart_rx_get_packet_crc() and the CRC is started again. A packet
+ * ends at the packet callback with uart_rx_set_framing(), where the CRC
+ * covers the decoded bytes, and otherwise at the idle callback, or the idle
+ * END token when streaming, with uart_rx_set_idle_timeout().
+ *
+ * \param uart          The uart_rx_t context.
+ * \param crc           The CRC, set up with uart_crc_init() or
+ *                      uart_crc_init_preset(). It is copied. NULL disables.
+ */
+void uart_rx_set_crc(
+        uart_rx_t *uart,
+        const uart_crc_t *crc);
+
+/**
+ * Gets the CRC of the last packet received with uart_rx_set_crc() enabled.
+ * Call from the idle or packet callback. The CRC covers the whole packet, so
+ * for a packet ending in its own CRC, as sent by uart_tx_send_crc(), it is
+ * the fixed residue of the CRC when the packet is good. The residue is 0 for
+ * the presets other than UART_CRC_32, and is given by uart_crc_residue().
+ *
+ * \param uart          The uart_rx_t context.
+ *
+ * \return              The CRC of the last packet.
+ */
+uint32_t uart_rx_get_packet_crc(uart_rx_t *uart);
+
+/**
+ * Takes a consistent snapshot of the statistics of a UART Rx. Needs
+ * UART_STATS_ENABLED, otherwise the snapshot is all zero.
+ *
+ * \param uart          The uart_rx_t context.
+ * \param stats         Filled in with the statistics.
+ */
+void uart_rx_get_stats(
+        uart_rx_t *uart,
+        uart_stats_t *stats);
+
+/**
+ * Clears the statistics of a UART Rx, eg. after each telemetry snapshot.
+ *
+ * \param uart          The uart_rx_t context.
+ */
+void uart_rx_reset_stats(
+        uart_rx_t *uart);
+
 /**
  * De-initializes the specified UART Rx interface. This disables the
- * port also. The timer, if used, needs to be freed by the application.
+ * port also, and the clock block when oversampled. The timer, if used,
+ * needs to be freed by the application.
  *
  * \param uart          The uart_rx_t context to de-initialise.
  */
@@ -321,3 +1170,385 @@ void uart_rx_deinit(uart_rx_t *uart);
 
 
 /**@}*/ // END: addtogroup hil_uart_rx
+
+/**
+ * \addtogroup hil_uart_tx_multi hil_uart_tx_multi
+ *
+ * The public API for using the HIL UART multi-line Tx module. This drives
+ * up to 8 UARTs sharing one baud rate on a single 4b or 8b port from a single
+ * thread, without any timers or interrupts.
+ * @{
+ */
+
+/**
+ * The maximum number of Tx lines handled by one uart_tx_multi_t
+ */
+#define UART_TX_MULTI_MAX_LINES 8
+
+/**
+ * Struct to hold the context of one line of a multi-line UART Tx.
+ *
+ * The members in this struct should not be accessed directly. Use the
+ * API provided instead.
+ */
+typedef struct {
+    uart_state_t state;
+    uart_parity_t parity;
+    uint8_t num_data_bits;
+    uint8_t stop_bits;
+    uint8_t bits_left;
+    uint32_t frame;
+
+    HIL_UART_TX_CALLBACK_ATTR void(*uart_tx_empty_callback_fptr)(void* app_data);
+    void *app_data;
+    uart_ring_t buffer;
+} uart_tx_multi_line_t;
+
+/**
+ * Struct to hold a multi-line UART Tx context.
+ *
+ * The members in this struct should not be accessed directly. Use the
+ * API provided instead.
+ */
+typedef struct {
+    port_t tx_port;
+    uint32_t port_width;
+    uint32_t bit_time_ticks;
+    uint32_t bit_time_frac; //16b fraction of a tick
+    uint32_t line_mask;
+    uart_tx_multi_line_t line[UART_TX_MULTI_MAX_LINES];
+} uart_tx_multi_t;
+
+/**
+ * Initializes a multi-line UART Tx. All lines share one bit clock, which is
+ * kept by timed outputs on the port so no timer is needed. Lines are added
+ * with uart_tx_multi_line_init() and the transmitter is run by calling
+ * uart_tx_multi() from its own thread. All lines are driven high (idle).
+ *
+ * \param ctx           The uart_tx_multi_t context to initialise.
+ * \param tx_port       The 4b or 8b port the Tx lines are connected to.
+ * \param port_width    The width of tx_port in bits. 4 or 8.
+ * \param baud_rate     The baud rate of all lines in bits per second.
+ */
+void uart_tx_multi_init(
+        uart_tx_multi_t *ctx,
+        port_t tx_port,
+        uint32_t port_width,
+        uint32_t baud_rate);
+
+/**
+ * Adds a line to a multi-line UART Tx. Each line has its own frame format,
+ * buffer and empty callback.
+ *
+ * \param ctx           The uart_tx_multi_t context.
+ * \param line          The port bit the line is connected to.
+ * \param data_bits     The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param tx_buff       Pointer to the buffer for data to send.
+ * \param buffer_size_plus_one   Size of the buffer. The buffer holds the
+ *                      largest power of two bytes that fits, eg. 64 for buff[65].
+ * \param uart_tx_empty_callback_fptr Callback function pointer for when the
+ *                      last frame queued on this line has been sent. Optionally NULL.
+ * \param app_data      A pointer to application specific data passed to
+ *                      the callback of this line.
+ */
+void uart_tx_multi_line_init(
+        uart_tx_multi_t *ctx,
+        unsigned line,
+        uint8_t data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *tx_buff,
+        size_t buffer_size_plus_one,
+        void(*uart_tx_empty_callback_fptr)(void* app_data),
+        void *app_data
+        );
+
+/**
+ * Runs the multi-line UART Tx. This function does not return and must be
+ * given its own thread. The empty callbacks are called from this thread.
+ *
+ * \param ctx           The uart_tx_multi_t context.
+ */
+void uart_tx_multi(uart_tx_multi_t *ctx);
+
+/**
+ * Queues a byte for sending on a line of a multi-line UART Tx. This may be
+ * called from any thread on the same tile.
+ *
+ * \param ctx           The uart_tx_multi_t context.
+ * \param line          The line to send on.
+ * \param data          The word to send.
+ *
+ * \return              UART_BUFFER_OK or UART_BUFFER_FULL if the byte could
+ *                      not be queued.
+ */
+uart_buffer_error_t uart_tx_multi_write(uart_tx_multi_t *ctx, unsigned line, uint8_t data);
+
+/**@}*/ // END: addtogroup hil_uart_tx_multi
+
+/**
+ * \addtogroup hil_uart_rx_multi hil_uart_rx_multi
+ *
+ * The public API for using the HIL UART multi-line Rx module. This receives
+ * up to 8 UARTs on a single 4b or 8b port from a single thread, without any
+ * timers or interrupts.
+ * @{
+ */
+
+/**
+ * The maximum number of Rx lines handled by one uart_rx_multi_t
+ */
+#define UART_RX_MULTI_MAX_LINES 8
+
+/**
+ * Struct to hold the context of one line of a multi-line UART Rx.
+ *
+ * The members in this struct should not be accessed directly. Use the
+ * API provided instead.
+ */
+typedef struct {
+    uart_state_t state;
+    uint32_t samples_per_bit_q16;
+    int32_t countdown_q16;
+    uart_parity_t parity;
+    uint8_t num_data_bits;
+    uint8_t current_data_bit;
+    uint8_t uart_data;
+
+    uart_callback_code_t cb_code;
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_complete_callback_arg)(void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_error_callback_arg)(uart_callback_code_t callback_code, void* app_data);
+    void *app_data;
+    uart_ring_t buffer;
+} uart_rx_multi_line_t;
+
+/**
+ * Struct to hold a multi-line UART Rx context.
+ *
+ * The members in this struct should not be accessed directly. Use the
+ * API provided instead.
+ */
+typedef struct {
+    port_t rx_port;
+    xclock_t clk;
+    uint32_t port_width;
+    uint32_t sample_rate;
+    uint32_t line_mask;
+    uint32_t idle_mask;
+    uint32_t prev_sample;
+    uart_rx_multi_line_t line[UART_RX_MULTI_MAX_LINES];
+} uart_rx_multi_t;
+
+/**
+ * Initializes a multi-line UART Rx. The port is sampled at a fixed rate from
+ * a clock block and each line, one per port bit, runs its own Rx state machine
+ * on every sample. Lines are added with uart_rx_multi_line_init() and the
+ * receiver is run by calling uart_rx_multi() from its own thread.
+ *
+ * \param ctx           The uart_rx_multi_t context to initialise.
+ * \param rx_port       The 4b or 8b port the Rx lines are connected to.
+ * \param port_width    The width of rx_port in bits. 4 or 8.
+ * \param clk           The clock block used to clock the port. It is
+ *                      enabled by this function.
+ * \param sample_rate   The rate in Hz at which the lines are sampled. This is
+ *                      divided down from the 100MHz reference clock. It should
+ *                      be at least 4 times the fastest baud rate used, and is
+ *                      limited by how fast the thread can run all the lines.
+ */
+void uart_rx_multi_init(
+        uart_rx_multi_t *ctx,
+        port_t rx_port,
+        uint32_t port_width,
+        xclock_t clk,
+        uint32_t sample_rate);
+
+/**
+ * Adds a line to a multi-line UART Rx. Each line has its own baud rate, frame
+ * format, buffer and callbacks. Errors are reported as for uart_rx_init().
+ *
+ * \param ctx           The uart_rx_multi_t context.
+ * \param line          The port bit the line is connected to.
+ * \param baud_rate     The baud rate of the line in bits per second.
+ * \param data_bits     The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param rx_buff       Pointer to the buffer for received data.
+ * \param buffer_size_plus_one   Size of the buffer. The buffer holds the
+ *                      largest power of two bytes that fits, eg. 64 for buff[65].
+ * \param uart_rx_complete_callback_fptr Callback function pointer for a frame
+ *                      received on this line. Optionally NULL.
+ * \param uart_rx_error_callback_fptr Callback function pointer for Rx errors
+ *                      on this line.
+ * \param app_data      A pointer to application specific data passed to
+ *                      the callbacks of this line.
+ */
+void uart_rx_multi_line_init(
+        uart_rx_multi_t *ctx,
+        unsigned line,
+        uint32_t baud_rate,
+        uint8_t data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *rx_buff,
+        size_t buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        );
+
+/**
+ * Runs the multi-line UART Rx. This function does not return and must be
+ * given its own thread. The line callbacks are called from this thread.
+ *
+ * \param ctx           The uart_rx_multi_t context.
+ */
+void uart_rx_multi(uart_rx_multi_t *ctx);
+
+/**
+ * Gets the oldest byte received on a line of a multi-line UART Rx. This may be
+ * called from any thread on the same tile.
+ *
+ * \param ctx           The uart_rx_multi_t context.
+ * \param line          The line to read from.
+ * \param data          Pointer to where the byte is stored.
+ *
+ * \return              UART_BUFFER_OK or UART_BUFFER_EMPTY if there was nothing
+ *                      to read.
+ */
+uart_buffer_error_t uart_rx_multi_read(uart_rx_multi_t *ctx, unsigned line, uint8_t *data);
+
+/**@}*/ // END: addtogroup hil_uart_rx_multi
+
+/**
+ * \addtogroup hil_uart_hs hil_uart_hs
+ *
+ * The public API for using the HIL UART high speed module. This runs a full
+ * duplex UART in a single thread at 12.5MHz / n baud, with both ports clocked
+ * from one clock block and whole words of bits shifted in and out. The highest
+ * rates need a fast logical core, see uart_hs().
+ * @{
+ */
+
+/**
+ * The number of port clocks per bit of a high speed UART. The Rx finds the
+ * start bit edge to within a quarter of a bit and samples the middle two.
+ */
+#define UART_HS_SAMPLES_PER_BIT 4
+
+/**
+ * Struct to hold a high speed UART context.
+ *
+ * The members in this struct should not be accessed directly. Use the
+ * API provided instead.
+ */
+typedef struct {
+    port_t tx_port;
+    port_t rx_port;
+    xclock_t clk;
+    uart_parity_t parity;
+    uint8_t num_data_bits;
+    uint8_t tx_frame_bits; //Start, data, parity and stop bits
+    uint8_t rx_frame_bits; //As Tx but only the first stop bit is checked
+    uint8_t stop_bits;
+
+    uint32_t tx_bits; //Line bits not yet sent, LSb first
+    uint32_t tx_num_bits;
+
+    uint32_t rx_pos; //Sample of the next bit centre, or where to look for a start bit, in the next word
+    uint32_t rx_bits_left; //Zero when idle
+    uint32_t rx_frame; //Received bits are shifted in at the top
+
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_complete_callback_arg)(void* app_data);
+    HIL_UART_RX_CALLBACK_ATTR void(*uart_rx_error_callback_arg)(uart_callback_code_t callback_code, void* app_data);
+    void *app_data;
+    uart_ring_t tx_buffer;
+    uart_ring_t rx_buffer;
+} uart_hs_t;
+
+/**
+ * Initializes a high speed UART. The Tx and Rx ports are both clocked at
+ * UART_HS_SAMPLES_PER_BIT times the baud rate from one clock block divided
+ * from the 100MHz reference clock, so the achieved baud rate is the nearest
+ * of 12.5MHz / n. The UART is run by calling uart_hs() from its own thread.
+ * The Tx line is driven high (idle).
+ *
+ * \param ctx           The uart_hs_t context to initialise.
+ * \param tx_port       The 1b port used to transmit.
+ * \param rx_port       The 1b port used to receive.
+ * \param clk           The clock block used for both ports.
+ * \param baud_rate     The baud rate, up to 12500000.
+ * \param num_data_bits The number of data bits per frame sent.
+ * \param parity        The type of parity used. See uart_parity_t above.
+ * \param stop_bits     The number of stop bits asserted at the of the frame.
+ * \param tx_buff       The Tx buffer.
+ * \param tx_buffer_size_plus_one The size of tx_buff.
+ * \param rx_buff       The Rx buffer.
+ * \param rx_buffer_size_plus_one The size of rx_buff.
+ * \param uart_rx_complete_callback_fptr Optional callback function pointer for
+ *                      each word received. Called from the uart_hs() thread.
+ * \param uart_rx_error_callback_fptr Optional callback function pointer for
+ *                      receive errors. Called from the uart_hs() thread.
+ * \param app_data      A pointer to application specific data passed to
+ *                      the callbacks.
+ */
+void uart_hs_init(
+        uart_hs_t *ctx,
+        port_t tx_port,
+        port_t rx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *tx_buff,
+        size_t tx_buffer_size_plus_one,
+        uint8_t *rx_buff,
+        size_t rx_buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        );
+
+/**
+ * Runs the high speed UART. This function does not return and must be
+ * given its own thread. Each pass takes one word of samples from the Rx port,
+ * which sets the pace, and gives one word of bits to the Tx port. A pass must
+ * finish within 8 bit times. 12.5 Mbaud has been checked in simulation with
+ * only this and one other thread running on the tile; with more threads each
+ * gets less of the core and a lower rate may be needed.
+ *
+ * \param ctx           The uart_hs_t context.
+ */
+void uart_hs(uart_hs_t *ctx);
+
+/**
+ * Queues words for transmit on a high speed UART. This may be called from any
+ * thread on the same tile, but only one thread may write.
+ *
+ * \param ctx           The uart_hs_t context.
+ * \param data          Pointer to the words to transmit.
+ * \param n             The number of words to transmit.
+ *
+ * \return              The number of words queued, which is less than n if
+ *                      the Tx buffer fills.
+ */
+size_t uart_hs_write(uart_hs_t *ctx, const uint8_t *data, size_t n);
+
+/**
+ * Gets the oldest words received by a high speed UART. This may be called from
+ * any thread on the same tile, but only one thread may read.
+ *
+ * \param ctx           The uart_hs_t context.
+ * \param data          Pointer to where the words are stored.
+ * \param n             The maximum number of words to read.
+ *
+ * \return              The number of words read, which may be 0.
+ */
+size_t uart_hs_read(uart_hs_t *ctx, uint8_t *data, size_t n);
+
+/**@}*/ // END: addtogroup hil_uart_hs
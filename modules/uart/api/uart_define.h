@@ -0,0 +1,148 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#pragma once
+
+/**
+ * \addtogroup hil_uart_define hil_uart_define
+ *
+ * The public API for defining UARTs specialised for a fixed frame format.
+ * @{
+ */
+
+#include <xcore/assert.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "uart_tx_impl.h"
+#include "uart_rx_impl.h"
+
+/**
+ * Defines a timer driven UART Tx specialised for one frame format and mode.
+ * The state machine is compiled with the format as constants, so the parity,
+ * stop bit and buffer checks are folded out of the ISR. The runtime feature
+ * checks are folded out too, so uart_tx_set_rs485(), uart_tx_set_cts(),
+ * uart_tx_set_low_watermark(), uart_tx_set_multi_producer() and uart_tx_wait()
+ * assert if used with a specialised UART Tx.
+ *
+ * Use at file scope. For BUFFERED this defines:
+ *
+ *  - ``void name_init(uart_tx_t *uart, port_t tx_port, uint32_t baud_rate, hwtimer_t tmr,
+ *    uint8_t *buffer, size_t buffer_size_plus_one, void(*uart_tx_empty_callback_fptr)(void* app_data),
+ *    void *app_data)``
+ *  - ``void name_tx(uart_tx_t *uart, uint8_t data)``
+ *
+ * and for BLOCKING:
+ *
+ *  - ``void name_init(uart_tx_t *uart, port_t tx_port, uint32_t baud_rate, hwtimer_t tmr)``
+ *  - ``void name_tx(uart_tx_t *uart, uint8_t data)``
+ *
+ * Otherwise the resulting uart_tx_t may be used with the rest of the Tx API as normal.
+ *
+ * \param name          The prefix of the functions defined.
+ * \param data_bits     The number of data bits per frame, 5 to 8.
+ * \param parity        NONE, EVEN or ODD.
+ * \param stop_bits     The number of stop bits, 1 or 2.
+ * \param mode          BUFFERED or BLOCKING.
+ */
+#define UART_TX_DEFINE(name, data_bits, parity, stop_bits, mode) \
+    UART_TX_DEFINE_##mode(name, data_bits, UART_PARITY_##parity, stop_bits)
+
+#define UART_TX_DEFINE_BUFFERED(name, data_bits, parity, stop_bits) \
+    DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, name##_isr, callback_info){ \
+        uart_tx_t *uart = (uart_tx_t *)callback_info; \
+        UART_STATS_ISR_BEGIN(uart); \
+        uart_tx_handle_event_impl(uart, data_bits, parity, stop_bits, 1, 0); \
+        UART_STATS_ISR_END(uart); \
+    } \
+    void name##_init(uart_tx_t *uart, port_t tx_port, uint32_t baud_rate, hwtimer_t tmr, \
+            uint8_t *buffer, size_t buffer_size_plus_one, \
+            void(*uart_tx_empty_callback_fptr)(void* app_data), void *app_data){ \
+        xassert(buffer != NULL); \
+        uart_tx_init(uart, tx_port, baud_rate, data_bits, parity, stop_bits, tmr, \
+                     buffer, buffer_size_plus_one, uart_tx_empty_callback_fptr, app_data); \
+        triggerable_setup_interrupt_callback(tmr, uart, INTERRUPT_CALLBACK(name##_isr)); \
+        uart->specialised = 1; \
+    } \
+    void name##_tx(uart_tx_t *uart, uint8_t data){ \
+        uart_tx(uart, data); \
+    }
+
+#define UART_TX_DEFINE_BLOCKING(name, data_bits, parity, stop_bits) \
+    void name##_init(uart_tx_t *uart, port_t tx_port, uint32_t baud_rate, hwtimer_t tmr){ \
+        uart_tx_blocking_init(uart, tx_port, baud_rate, data_bits, parity, stop_bits, tmr); \
+        uart->specialised = 1; \
+    } \
+    void name##_tx(uart_tx_t *uart, uint8_t data){ \
+        uart_tx_blocking_impl(uart, data & ((1 << (data_bits)) - 1), data_bits, parity, stop_bits, 0); \
+    }
+
+/**
+ * Defines a timer driven UART Rx specialised for one frame format and mode.
+ * The state machine is compiled with the format as constants, so the parity
+ * and buffer checks are folded out of the ISR. The runtime feature checks are
+ * folded out too, so the uart_rx_set_*() feature setters, from autobaud to the
+ * idle timeout, assert if used with a specialised UART Rx. The format is fixed
+ * so uart_rx_set_multidrop() may not be used either.
+ *
+ * Use at file scope. For BUFFERED this defines:
+ *
+ *  - ``void name_init(uart_rx_t *uart, port_t rx_port, uint32_t baud_rate, hwtimer_t tmr,
+ *    uint8_t *buffer, size_t buffer_size_plus_one, void(*uart_rx_complete_callback_fptr)(void *app_data),
+ *    void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data), void *app_data)``
+ *  - ``uint8_t name_rx(uart_rx_t *uart)``
+ *
+ * and for BLOCKING:
+ *
+ *  - ``void name_init(uart_rx_t *uart, port_t rx_port, uint32_t baud_rate, hwtimer_t tmr,
+ *    void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data), void *app_data)``
+ *  - ``uint8_t name_rx(uart_rx_t *uart)``
+ *
+ * Otherwise the resulting uart_rx_t may be used with the rest of the Rx API as normal.
+ *
+ * \param name          The prefix of the functions defined.
+ * \param data_bits     The number of data bits per frame, 5 to 8.
+ * \param parity        NONE, EVEN or ODD.
+ * \param stop_bits     The number of stop bits, 1 or 2.
+ * \param mode          BUFFERED or BLOCKING.
+ */
+#define UART_RX_DEFINE(name, data_bits, parity, stop_bits, mode) \
+    UART_RX_DEFINE_##mode(name, data_bits, UART_PARITY_##parity, stop_bits)
+
+#define UART_RX_DEFINE_BUFFERED(name, data_bits, parity, stop_bits) \
+    DEFINE_INTERRUPT_CALLBACK(UART_RX_INTERRUPTABLE_FUNCTIONS, name##_isr, callback_info){ \
+        uart_rx_t *uart = (uart_rx_t *)callback_info; \
+        UART_STATS_ISR_BEGIN(uart); \
+        uart_rx_handle_event_impl(uart, data_bits, parity, 1, 0); \
+        UART_STATS_ISR_END(uart); \
+    } \
+    void name##_init(uart_rx_t *uart, port_t rx_port, uint32_t baud_rate, hwtimer_t tmr, \
+            uint8_t *buffer, size_t buffer_size_plus_one, \
+            void(*uart_rx_complete_callback_fptr)(void *app_data), \
+            void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data), \
+            void *app_data){ \
+        xassert(buffer != NULL); \
+        uart_rx_init(uart, rx_port, baud_rate, data_bits, parity, stop_bits, tmr, buffer, buffer_size_plus_one, \
+                     uart_rx_complete_callback_fptr, uart_rx_error_callback_fptr, app_data); \
+        interrupt_mask_all(); \
+        triggerable_setup_interrupt_callback(rx_port, uart, INTERRUPT_CALLBACK(name##_isr)); \
+        triggerable_setup_interrupt_callback(tmr, uart, INTERRUPT_CALLBACK(name##_isr)); \
+        interrupt_unmask_all(); \
+        uart->specialised = 1; \
+    } \
+    uint8_t name##_rx(uart_rx_t *uart){ \
+        return uart_rx(uart); \
+    }
+
+#define UART_RX_DEFINE_BLOCKING(name, data_bits, parity, stop_bits) \
+    void name##_init(uart_rx_t *uart, port_t rx_port, uint32_t baud_rate, hwtimer_t tmr, \
+            void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data), \
+            void *app_data){ \
+        uart_rx_blocking_init(uart, rx_port, baud_rate, data_bits, parity, stop_bits, tmr, \
+                              uart_rx_error_callback_fptr, app_data); \
+        uart->specialised = 1; \
+    } \
+    uint8_t name##_rx(uart_rx_t *uart){ \
+        return uart_rx_blocking_impl(uart, data_bits, parity, 0); \
+    }
+
+/**@}*/ // END: addtogroup hil_uart_define
@@ -0,0 +1,53 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/**
+ * This file contains the frame and port helpers shared by the UART Tx and Rx implementations
+ */
+
+#pragma once
+#include <stdint.h>
+#include <xcore/port.h>
+
+#include "uart.h"
+
+/* outpw is not exposed by lib_xcore */
+__attribute__((always_inline))
+inline void uart_port_outpw(
+        resource_t __p,
+        uint32_t __w,
+        uint32_t __bpw)
+{
+    asm volatile("outpw res[%0], %1, %2" : : "r" (__p), "r" (__w), "r" (__bpw));
+}
+
+/**
+ * Returns the parity bit (0 or 1) to send or expect for the data word
+ */
+__attribute__((always_inline))
+inline uint32_t uart_parity_bit(uint32_t data, uart_parity_t parity_type){
+    uint32_t parity_setting = (parity_type == UART_PARITY_EVEN) ? 0 : 1;
+    uint32_t parity = data;
+    // crc32(parity, parity_setting, 1); //http://bugzilla/show_bug.cgi?id=18663
+    asm volatile("crc32 %0, %2, %3" : "=r" (parity) : "0" (parity), "r" (parity_setting), "r" (1));
+    return parity & 1;
+}
+
+/**
+ * Returns the 16b fraction of a tick left over from XS1_TIMER_HZ / baud_rate
+ */
+__attribute__((always_inline))
+inline uint32_t uart_bit_time_frac(uint32_t baud_rate){
+    return ((uint64_t)(XS1_TIMER_HZ % baud_rate) << 16) / baud_rate;
+}
+
+/**
+ * Returns the number of ticks to the next bit, carrying the fractional part
+ * of the bit time in the 16b accumulator so there is no drift across a frame.
+ */
+__attribute__((always_inline))
+inline uint32_t uart_next_bit_ticks(uint32_t *acc, uint32_t bit_time_ticks, uint32_t bit_time_frac){
+    uint32_t sum = *acc + bit_time_frac;
+    *acc = sum & 0xffff;
+    return bit_time_ticks + (sum >> 16);
+}
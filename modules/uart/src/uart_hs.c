@@ -0,0 +1,192 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <xclib.h>
+#include <xcore/assert.h>
+
+#include "uart.h"
+#include "uart_frame.h"
+
+#define UART_HS_MAX_DIVIDE  255
+
+/* Each line bit is sent as UART_HS_SAMPLES_PER_BIT port bits, so a nibble of line bits fills 16 port bits */
+static const uint16_t uart_hs_tx_lut[16] = {
+    0x0000, 0x000f, 0x00f0, 0x00ff, 0x0f00, 0x0f0f, 0x0ff0, 0x0fff,
+    0xf000, 0xf00f, 0xf0f0, 0xf0ff, 0xff00, 0xff0f, 0xfff0, 0xffff,
+};
+
+void uart_hs_init(
+        uart_hs_t *ctx,
+        port_t tx_port,
+        port_t rx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *tx_buff,
+        size_t tx_buffer_size_plus_one,
+        uint8_t *rx_buff,
+        size_t rx_buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        ){
+
+    xassert(num_data_bits <= 8 && num_data_bits >= 5);
+    xassert(parity == UART_PARITY_NONE || parity == UART_PARITY_EVEN || parity == UART_PARITY_ODD);
+    xassert(stop_bits == 1 || stop_bits == 2);
+    xassert(tx_buff != NULL && rx_buff != NULL);
+
+    //The port clock is 100MHz / 2n
+    uint32_t sample_rate = baud_rate * UART_HS_SAMPLES_PER_BIT;
+    uint32_t divide = (XS1_TIMER_HZ / 2 + sample_rate / 2) / sample_rate; //Round to nearest
+    xassert(divide >= 1 && divide <= UART_HS_MAX_DIVIDE);
+
+    ctx->tx_port = tx_port;
+    ctx->rx_port = rx_port;
+    ctx->clk = clk;
+    ctx->parity = parity;
+    ctx->num_data_bits = num_data_bits;
+    ctx->stop_bits = stop_bits;
+    ctx->rx_frame_bits = 1 + num_data_bits + (parity != UART_PARITY_NONE) + 1;
+    ctx->tx_frame_bits = ctx->rx_frame_bits - 1 + stop_bits;
+    ctx->tx_bits = 0;
+    ctx->tx_num_bits = 0;
+    ctx->rx_pos = 0;
+    ctx->rx_bits_left = 0;
+    ctx->rx_frame = 0;
+    ctx->uart_rx_complete_callback_arg = uart_rx_complete_callback_fptr;
+    ctx->uart_rx_error_callback_arg = uart_rx_error_callback_fptr;
+    ctx->app_data = app_data;
+    uart_ring_init(&ctx->tx_buffer, tx_buff, tx_buffer_size_plus_one);
+    uart_ring_init(&ctx->rx_buffer, rx_buff, rx_buffer_size_plus_one);
+
+    clock_enable(clk);
+    clock_set_source_clk_ref(clk);
+    clock_set_divide(clk, divide);
+
+    //Both ports run from the same clock so the Rx port input paces the Tx port output
+    port_start_buffered(tx_port, 32);
+    port_set_clock(tx_port, clk);
+    port_start_buffered(rx_port, 32);
+    port_set_clock(rx_port, clk);
+    port_out(tx_port, 0xffffffff); //Idle, and a word of slack ahead of the Rx
+}
+
+/**
+ * Returns the next word of port bits for the Tx, starting new frames as the
+ * line bits run low and filling with idle when the buffer is empty.
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_hs_tx_word(uart_hs_t *ctx){
+    const uint32_t line_bits = 32 / UART_HS_SAMPLES_PER_BIT;
+    uint32_t bits = ctx->tx_bits;
+    uint32_t num_bits = ctx->tx_num_bits;
+
+    while(num_bits < line_bits){
+        uint8_t data;
+        if(uart_ring_pop_byte(&ctx->tx_buffer, &data) != UART_BUFFER_OK){
+            bits |= (0xff << num_bits) & 0xff; //Idle high
+            num_bits = line_bits;
+            break;
+        }
+        uint32_t n = ctx->num_data_bits;
+        data &= (1 << n) - 1;
+        uint32_t frame = (uint32_t)data << 1; //Start bit is 0
+        if(ctx->parity != UART_PARITY_NONE){
+            frame |= uart_parity_bit(data, ctx->parity) << (1 + n);
+        }
+        frame |= ((1 << ctx->stop_bits) - 1) << (ctx->tx_frame_bits - ctx->stop_bits);
+        bits |= frame << num_bits;
+        num_bits += ctx->tx_frame_bits;
+    }
+
+    uint32_t out = bits & 0xff;
+    ctx->tx_bits = bits >> line_bits;
+    ctx->tx_num_bits = num_bits - line_bits;
+    return uart_hs_tx_lut[out & 0xf] | (uart_hs_tx_lut[out >> 4] << 16);
+}
+
+/**
+ * Checks a received frame, LSb first from the start bit, and buffers the word
+ */
+__attribute__((always_inline))
+static inline void uart_hs_rx_frame(uart_hs_t *ctx, uint32_t frame){
+    uint32_t n = ctx->num_data_bits;
+    uint8_t data = (frame >> 1) & ((1 << n) - 1);
+    uart_callback_code_t cb_code = UART_RX_COMPLETE;
+    if(frame & 0x1){
+        cb_code = UART_START_BIT_ERROR;
+    } else if(ctx->parity != UART_PARITY_NONE && ((frame >> (1 + n)) & 0x1) != uart_parity_bit(data, ctx->parity)){
+        cb_code = UART_PARITY_ERROR;
+    } else if(!(frame >> (ctx->rx_frame_bits - 1))){
+        cb_code = UART_FRAMING_ERROR;
+    }
+    if(cb_code != UART_RX_COMPLETE && ctx->uart_rx_error_callback_arg != NULL){
+        (*ctx->uart_rx_error_callback_arg)(cb_code, ctx->app_data);
+    }
+
+    if(uart_ring_push_byte(&ctx->rx_buffer, data) == UART_BUFFER_FULL){
+        if(ctx->uart_rx_error_callback_arg != NULL){
+            (*ctx->uart_rx_error_callback_arg)(UART_OVERRUN_ERROR, ctx->app_data);
+        }
+    } else if(ctx->uart_rx_complete_callback_arg != NULL){
+        (*ctx->uart_rx_complete_callback_arg)(ctx->app_data);
+    }
+}
+
+/**
+ * Decodes a word of Rx samples, oldest at the bottom. A start bit is found
+ * from its first low sample and every bit of the frame is then sampled half
+ * a bit later, so the phase is set again for each frame.
+ */
+__attribute__((always_inline))
+static inline void uart_hs_rx_word(uart_hs_t *ctx, uint32_t word){
+    uint32_t pos = ctx->rx_pos;
+    uint32_t bits_left = ctx->rx_bits_left;
+    uint32_t frame = ctx->rx_frame;
+
+    while(pos < 32){
+        if(bits_left == 0){
+            uint32_t lows = ~word & (0xffffffff << pos);
+            if(lows == 0){
+                pos = 32; //Look from the start of the next word
+                break;
+            }
+            pos = clz(bitrev(lows)) + UART_HS_SAMPLES_PER_BIT / 2; //Centre of the start bit
+            bits_left = ctx->rx_frame_bits;
+            continue;
+        }
+        frame = (frame >> 1) | ((word >> pos) << 31);
+        pos += UART_HS_SAMPLES_PER_BIT;
+        bits_left -= 1;
+        if(bits_left == 0){
+            uart_hs_rx_frame(ctx, frame >> (32 - ctx->rx_frame_bits));
+            //Allow the next start bit to begin a little early, as the far end clock may be fast
+            pos -= UART_HS_SAMPLES_PER_BIT - 1;
+        }
+    }
+
+    ctx->rx_pos = pos - 32;
+    ctx->rx_bits_left = bits_left;
+    ctx->rx_frame = frame;
+}
+
+void uart_hs(uart_hs_t *ctx){
+    clock_start(ctx->clk);
+    for(;;){
+        uint32_t samples = port_in(ctx->rx_port);
+        port_out(ctx->tx_port, uart_hs_tx_word(ctx));
+        uart_hs_rx_word(ctx, samples);
+    }
+}
+
+size_t uart_hs_write(uart_hs_t *ctx, const uint8_t *data, size_t n){
+    return uart_ring_push(&ctx->tx_buffer, data, n);
+}
+
+size_t uart_hs_read(uart_hs_t *ctx, uint8_t *data, size_t n){
+    return uart_ring_pop(&ctx->rx_buffer, data, n);
+}
@@ -1,17 +1,23 @@
 // Copyright 2022 XMOS LIMITED.
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 #include <stdint.h>
+#include <xclib.h>
 #include <xcore/assert.h>
+#include <xcore/chanend.h>
 #include <xcore/interrupt_wrappers.h>
 
 #include "uart.h"
+#include "uart_frame.h"
+#include "uart_rx_impl.h"
+#include "uart_stats.h"
 
-#define UART_RX_DEBUG 0 //Drives debug port for checking state timing in simulator
 #if UART_RX_DEBUG
 port_t p_dbg = XS1_PORT_32A;
 #endif
 
 DECLARE_INTERRUPT_CALLBACK(uart_rx_handle_isr, callback_info);
+DECLARE_INTERRUPT_CALLBACK(uart_rx_oversampled_isr, callback_info);
+DECLARE_INTERRUPT_CALLBACK(uart_rx_idle_isr, callback_info);
 
 void uart_rx_blocking_init(
         uart_rx_t *uart,
@@ -28,13 +34,28 @@ void uart_rx_blocking_init(
         NULL, 0, NULL, uart_rx_error_callback_fptr, app_data);
 }
 
-void uart_rx_init(
+void uart_rx_event_init(
         uart_rx_t *uart,
         port_t rx_port,
         uint32_t baud_rate,
         uint8_t num_data_bits,
         uart_parity_t parity,
         uint8_t stop_bits,
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data){
+
+    uart_rx_init(uart, rx_port, baud_rate, num_data_bits, parity, stop_bits, 0,
+        NULL, 0, NULL, uart_rx_error_callback_fptr, app_data);
+    xassert(uart->port_timed); //Samples are port time events so there is no timer
+    port_set_trigger_in_equal(rx_port, 0); //Event on low (start of start bit)
+}
+
+static void uart_rx_init_context(
+        uart_rx_t *uart,
+        port_t rx_port,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
 
         hwtimer_t tmr,
         uint8_t *buffer,
@@ -44,13 +65,12 @@ void uart_rx_init(
         void *app_data
         ){
 
-    #if UART_RX_DEBUG
-    port_enable(p_dbg);
-    #endif
-
     uart->rx_port = rx_port;
-    uart->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    uart->clk = 0;
+    uart->bit_time_frac = 0;
+    uart->bit_time_acc = 0;
     uart->next_event_time_ticks = 0;
+    uart->port_timed = 0;
     xassert(num_data_bits <= 8 && num_data_bits >= 5);
     uart->num_data_bits = num_data_bits;
     xassert(parity == UART_PARITY_NONE || parity == UART_PARITY_EVEN || parity == UART_PARITY_ODD);
@@ -63,27 +83,86 @@ void uart_rx_init(
     //HW timer will be replaced by poll if set to zero
     uart->tmr = tmr;
 
-    init_buffer(&uart->buffer, buffer, buffer_size_plus_one);
-    if(buffer_used(&uart->buffer)){
+    uart_ring_init(&uart->buffer, buffer, buffer_size_plus_one);
+    if(uart_ring_used(&uart->buffer)){
         xassert(buffer_size_plus_one > (1 + 1)); // Buffer must be at least one deep to be valid
         //From now on we just check to see if buffer is NULL or not for speed
     }
 
+    uart->idle_timeout_ticks = 0;
+    uart->idle_byte_count = 0;
+
     uart->cb_code = UART_RX_COMPLETE;
     uart->uart_rx_complete_callback_arg = uart_rx_complete_callback_fptr;
     uart->uart_rx_error_callback_arg = uart_rx_error_callback_fptr;
+    uart->uart_rx_idle_callback_arg = NULL;
+    uart->uart_rx_high_watermark_callback_arg = NULL;
+    uart->high_watermark = 0;
+    uart->rts_port = 0;
+    uart->rts_high_watermark = 0;
+    uart->rts_low_watermark = 0;
+    uart->rts_deasserted = 0;
+    uart->multidrop = 0;
+    uart->multidrop_address = 0;
+    uart->multidrop_mask = 0;
+    uart->multidrop_selected = 0;
+    uart->multidrop_frame_ok = 1;
+    uart->multidrop_marks = NULL;
+    uart->autobaud_mode = UART_AUTOBAUD_OFF;
+    uart->autobaud_edge_time = 0;
+    uart->uart_rx_autobaud_callback_arg = NULL;
+    uart->uart_rx_packet_callback_arg = NULL;
+    uart_deframer_init(&uart->deframer, UART_FRAMING_NONE, NULL, 0);
+    uart->timestamps = NULL;
+    uart->vote_ticks = 0;
+    uart->noise_detected = 0;
+    uart->edge_time_ticks = 0;
+    uart->port_time_offset = 0;
+    uart->stream_chanend = 0;
+    uart->stream_word = 0;
+    uart->stream_count = 0;
+    uart->crc.width = 0;
+    uart->packet_crc = 0;
+    uart->specialised = 0;
+    UART_STATS_RESET(uart);
     uart->app_data = app_data;
+}
+
+void uart_rx_init(
+        uart_rx_t *uart,
+        port_t rx_port,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        hwtimer_t tmr,
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        ){
+
+    #if UART_RX_DEBUG
+    port_enable(p_dbg);
+    #endif
+
+    uart_rx_init_context(uart, rx_port, num_data_bits, parity, stop_bits, tmr, buffer, buffer_size_plus_one,
+                         uart_rx_complete_callback_fptr, uart_rx_error_callback_fptr, app_data);
+    uart->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    uart->bit_time_frac = uart_bit_time_frac(baud_rate);
+    //Samples are timed on the 16b port timer unless a bit is too long to schedule ahead
+    uart->port_timed = uart->bit_time_ticks < 0x8000;
 
     //Assert if buffer is used but no timer as we need the timer for buffered mode 
-    if(buffer_used(&uart->buffer) && !tmr){
+    if(uart_ring_used(&uart->buffer) && !tmr){
         xassert(0);    
     }
 
     port_enable(rx_port);
 
-    if(buffer_used(&uart->buffer)){
-        init_buffer(&uart->buffer, buffer, buffer_size_plus_one);
-
+    if(uart_ring_used(&uart->buffer)){
         //Setup interrupts
         interrupt_mask_all();
         port_in(rx_port); //Ensure port is input and clear trigger
@@ -98,215 +177,593 @@ void uart_rx_init(
         triggerable_set_trigger_enabled(uart->tmr, 0);
 
         interrupt_unmask_all();
-    } else {
-        init_buffer(&uart->buffer, NULL, 0);
     }
 }
 
+/**
+ * Called by the application side after reading from the buffer
+ */
 __attribute__((always_inline))
-static inline uint32_t get_current_time(uart_rx_t *uart){
-    // if(uart->tmr){
-    //     return hwtimer_get_time(uart->tmr);
-    // }
-    //Note this has now been optimised since all timers share the same physical timer counter
-    return get_reference_time();
+static inline void uart_rx_check_rts_low_watermark(uart_rx_t *uart){
+    if(uart->rts_deasserted){
+        //Keep the ISR out so it cannot deassert between our check and assert
+        interrupt_mask_all();
+        if(uart_ring_fill_level(&uart->buffer) <= uart->rts_low_watermark){
+            port_out(uart->rts_port, 0);
+            uart->rts_deasserted = 0;
+        }
+        interrupt_unmask_all();
+    }
 }
 
+DEFINE_INTERRUPT_CALLBACK(UART_RX_INTERRUPTABLE_FUNCTIONS, uart_rx_handle_isr, callback_info){
+    uart_rx_t *uart = (uart_rx_t *)callback_info;
+    UART_STATS_ISR_BEGIN(uart);
+    uart_rx_handle_event_impl(uart, uart->num_data_bits, uart->parity, 1, UART_RX_FEATURES_ALL);
+    UART_STATS_ISR_END(uart);
+}
 
-__attribute__((always_inline))
-static inline void sleep_until_start_transition(uart_rx_t *uart){
-    if(uart->tmr){
-        //Wait on a port transition to low
-        port_in_when_pinseq(uart->rx_port, PORT_UNBUFFERED, 0);
-    }else{
-        //Poll the port
-        while(port_in(uart->rx_port) & 0x1);
+/**
+ * Sends the bytes of a partial streamed word, then an END token to mark the
+ * end of the burst
+ */
+static void uart_rx_stream_flush(uart_rx_t *uart){
+    for(int i = 0; i < uart->stream_count; i++){
+        s_chan_out_byte(uart->stream_chanend, uart->stream_word >> (8 * i));
     }
+    s_chan_out_ct_end(uart->stream_chanend);
+    uart->stream_word = 0;
+    uart->stream_count = 0;
 }
 
-__attribute__((always_inline))
-static inline void sleep_until_next_sample(uart_rx_t *uart){
-    if(uart->tmr){
-        //Wait on a the timer
-        hwtimer_wait_until(uart->tmr, uart->next_event_time_ticks);
-    }else{
-        //Poll the timer
-        while(get_current_time(uart) < uart->next_event_time_ticks);
+// With idle line detection the timer is left running between frames, so a timer
+// event while idle means the line has been idle long enough to end the packet.
+// Start edges still come from the port ISR and re-arm the timer for sampling.
+DEFINE_INTERRUPT_CALLBACK(UART_RX_INTERRUPTABLE_FUNCTIONS, uart_rx_idle_isr, callback_info){
+    uart_rx_t *uart = (uart_rx_t *)callback_info;
+    UART_STATS_ISR_BEGIN(uart);
+    if(uart->state != UART_IDLE){
+        uart_rx_handle_event_impl(uart, uart->num_data_bits, uart->parity, 1, UART_RX_FEATURES_ALL);
+        UART_STATS_ISR_END(uart);
+        return;
     }
+    hwtimer_clear_trigger_time(uart->tmr);
+    triggerable_set_trigger_enabled(uart->tmr, 0);
+    size_t num_bytes = uart->idle_byte_count;
+    uart->idle_byte_count = 0;
+    if(num_bytes){ //Nothing kept, eg. all frames were for other multidrop nodes
+        if(uart->crc.width && uart->deframer.type == UART_FRAMING_NONE){
+            uart->packet_crc = uart_crc_result(&uart->crc);
+            uart_crc_reset(&uart->crc);
+        }
+        if(uart->stream_chanend){
+            uart_rx_stream_flush(uart);
+        }
+        if(uart->uart_rx_idle_callback_arg != NULL){
+            (*uart->uart_rx_idle_callback_arg)(num_bytes, uart->app_data);
+        }
+    }
+    UART_STATS_ISR_END(uart);
 }
 
-// Interrupt latency and calling overhead has been measured at 510ns @ 75-120MHz thread speed 
-// Latency for polling/timer wait mode is around 320ns @ 75-120MHz thread speed   
-// These values have been experimentally derived using xsim (See enabling of debug in test_rx_uart.py)
-// and then inspecting the VCD waveform to see where the start bit samples in relation 
-// to the falling edge of the start bit. Turn on debug mode and observe p_dbg
+// clock_set_divide() takes an 8b divide value. The port clock is ref_clk / (2 * divide)
+#define UART_RX_OVERSAMPLED_MAX_DIVIDE  255
+
+void uart_rx_oversampled_init(
+        uart_rx_t *uart,
+        port_t rx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t oversample,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        ){
+
+    uart_rx_init_context(uart, rx_port, num_data_bits, parity, stop_bits, 0, buffer, buffer_size_plus_one,
+                         uart_rx_complete_callback_fptr, uart_rx_error_callback_fptr, app_data);
+    xassert(oversample == 4 || oversample == 8 || oversample == 16);
+
+    //Pick the slowest sample clock at or above the requested oversampling rate, so the
+    //real rate may be higher. Samples per bit come from the real sample_rate, not oversample
+    uint32_t divide = (XS1_TIMER_HZ / 2) / (baud_rate * oversample);
+    xassert(divide >= 1 && divide <= UART_RX_OVERSAMPLED_MAX_DIVIDE);
+    uint32_t sample_rate = (XS1_TIMER_HZ / 2) / divide;
+    uart->clk = clk;
+    uart->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    uart->samples_per_bit_q16 = ((uint64_t)sample_rate << 16) / baud_rate;
+    uart->sample_pos_q16 = 0;
+    uart->search_from = 64; //Nothing left to search in the (idle) initial samples
+    uart->samples[0] = 0xffffffff;
+    uart->samples[1] = 0xffffffff;
 
-#define INTERRUPT_LATENCY_COMPENSATION_TICKS (XS1_TIMER_MHZ * 510 / 1000)
-#define BLOCKING_LATENCY_COMPENSATION_TICKS  (XS1_TIMER_MHZ * 320 / 1000)
+    clock_enable(clk);
+    clock_set_source_clk_ref(clk);
+    clock_set_divide(clk, divide);
 
+    port_start_buffered(rx_port, 32);
+    port_set_clock(rx_port, clk);
+
+    if(uart_ring_used(&uart->buffer)){
+        //Setup interrupt. The port interrupts each time it has 32 samples ready
+        interrupt_mask_all();
+        triggerable_setup_interrupt_callback(rx_port, uart, INTERRUPT_CALLBACK(uart_rx_oversampled_isr) );
+        triggerable_set_trigger_enabled(uart->rx_port, 1);
+        clock_start(clk);
+        interrupt_unmask_all();
+    } else {
+        clock_start(clk);
+    }
+}
 
+/**
+ * Returns the index of the first low sample at or after index from
+ * in the 64 sample window, or -1 if there is none.
+ */
 __attribute__((always_inline))
-static inline void uart_rx_handle_event(uart_rx_t *uart){
-    switch(uart->state){
-        case UART_IDLE: {
-            #if UART_RX_DEBUG
-            port_out(p_dbg, uart->state);
-            #endif
-
-            uart->next_event_time_ticks = get_current_time(uart);
-            uart->next_event_time_ticks += uart->bit_time_ticks >> 1; //Halfway through start bit
-            uart->state = UART_START;
-            if(buffer_used(&uart->buffer)){
-                uart->next_event_time_ticks -= INTERRUPT_LATENCY_COMPENSATION_TICKS;
-                triggerable_set_trigger_enabled(uart->rx_port, 0);
-                port_clear_trigger_in(uart->rx_port);
-                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
-                triggerable_set_trigger_enabled(uart->tmr, 1);
-            } else {
-                uart->next_event_time_ticks -= BLOCKING_LATENCY_COMPENSATION_TICKS;
-            }
-            break;
+static inline int find_first_low_sample(uint32_t samples[2], uint32_t from){
+    for(int i = from >> 5; i < 2; i++){
+        uint32_t lows = ~samples[i];
+        if(i == (from >> 5)){
+            lows &= 0xffffffff << (from & 0x1f);
+        }
+        if(lows){
+            return (i << 5) + clz(bitrev(lows));
         }
+    }
+    return -1;
+}
 
-        case UART_START: {
-            #if UART_RX_DEBUG
-            port_out(p_dbg, uart->state);
-            #endif
+/**
+ * Majority vote of the three samples centred on index centre of the window
+ */
+__attribute__((always_inline))
+static inline uint32_t vote_sample(uint32_t samples[2], uint32_t centre){
+    uint64_t window = ((uint64_t)samples[1] << 32) | samples[0];
+    uint32_t three = (window >> (centre - 1)) & 0x7;
+    return (0xe8 >> three) & 0x1; //Set for 3, 5, 6 and 7
+}
 
-            uint32_t pin = port_in(uart->rx_port) & 0x1;
-            if(pin != 0){
-                uart->cb_code = UART_START_BIT_ERROR;
-                (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+/**
+ * Runs the Rx state machine over the current window of 64 samples, the newest 32 of
+ * which are not yet fully decoded. Returns 1 as soon as a frame has completed,
+ * leaving the position so that it can be called again to carry on with the same
+ * samples. Returns 0 once the samples are exhausted.
+ */
+static int uart_rx_oversampled_decode(uart_rx_t *uart){
+    for(;;){
+        if(uart->state == UART_IDLE){
+            int edge = find_first_low_sample(uart->samples, uart->search_from);
+            if(edge < 0){
+                uart->search_from = 64;
+                return 0;
             }
-            uart->state = UART_DATA;
-            uart->uart_data = 0;
-            uart->current_data_bit = 0;
-            uart->next_event_time_ticks += uart->bit_time_ticks;
-            if(buffer_used(&uart->buffer)){
-                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
-            }
-            break;
+            //The edge is between this and the previous sample, so half a sample earlier
+            uart->sample_pos_q16 = (edge << 16) - (1 << 15) + (uart->samples_per_bit_q16 >> 1);
+            uart->state = UART_START;
         }
 
-        case UART_DATA: { 
-            #if UART_RX_DEBUG
-            port_out(p_dbg, uart->state);
-            #endif
-
-            uint32_t pin = port_in(uart->rx_port) & 0x1;
-            uart->uart_data |= pin << uart->current_data_bit;
-            uart->current_data_bit += 1;
-
-            if(uart->current_data_bit == uart->num_data_bits){
-                if(uart->parity == UART_PARITY_NONE){
-                    uart->state = UART_STOP;
-                } else {
-                    uart->state = UART_PARITY;
+        uint32_t centre = (uart->sample_pos_q16 + (1 << 15)) >> 16;
+        if(centre + 1 >= 64){
+            return 0; //Need the next word to vote on this bit
+        }
+        uint32_t pin = vote_sample(uart->samples, centre);
+        uart->sample_pos_q16 += uart->samples_per_bit_q16;
+
+        switch(uart->state){
+            case UART_START: {
+                if(pin != 0){
+                    uart->cb_code = UART_START_BIT_ERROR;
+                    UART_STATS_ERROR(uart, uart->cb_code);
+                    (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+                    uart->state = UART_IDLE;
+                    uart->search_from = centre + 1;
+                    break;
                 }
+                uart->state = UART_DATA;
+                uart->uart_data = 0;
+                uart->current_data_bit = 0;
+                break;
             }
-            uart->next_event_time_ticks += uart->bit_time_ticks;
-            if(buffer_used(&uart->buffer)){
-                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
-            }
-            break;
-        }
 
-        case UART_PARITY: {
-            #if UART_RX_DEBUG
-            port_out(p_dbg, uart->state);
-            #endif
-
-            uint32_t pin = port_in(uart->rx_port) & 0x1;
-            uint32_t parity_setting = (uart->parity == UART_PARITY_EVEN) ? 0 : 1;
-            uint32_t parity = (unsigned)uart->uart_data;
-            // crc32(parity, parity_setting, 1); //http://bugzilla/show_bug.cgi?id=18663
-            asm volatile("crc32 %0, %2, %3" : "=r" (parity) : "0" (parity), "r" (parity_setting), "r" (1));
-            parity &= 1;
-            if(pin != parity){
-                uart->cb_code = UART_PARITY_ERROR;
-                (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
-            }
-            uart->state = UART_STOP;
-            uart->next_event_time_ticks += uart->bit_time_ticks;
-            if(buffer_used(&uart->buffer)){
-                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
-            }
-            break;
-        }
-     
-        case UART_STOP: {
-            #if UART_RX_DEBUG
-            port_out(p_dbg, uart->state);
-            #endif
-
-            uint32_t pin = port_in(uart->rx_port) & 0x1;
-            if(pin != 1){
-                uart->cb_code = UART_FRAMING_ERROR;
-                (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
-            } else {
-                uart->cb_code = UART_RX_COMPLETE;
+            case UART_DATA: {
+                uart->uart_data |= pin << uart->current_data_bit;
+                uart->current_data_bit += 1;
+                if(uart->current_data_bit == uart->num_data_bits){
+                    if(uart->parity == UART_PARITY_NONE){
+                        uart->state = UART_STOP;
+                    } else {
+                        uart->state = UART_PARITY;
+                    }
+                }
+                break;
             }
-            uart->state = UART_IDLE;
 
-            //Go back to waiting for next start bit transition
-            if(buffer_used(&uart->buffer)){
-                uart_buffer_error_t err = push_byte_into_buffer(&uart->buffer, uart->uart_data);
-                if(err == UART_BUFFER_FULL){
-                    uart->cb_code = UART_OVERRUN_ERROR;
+            case UART_PARITY: {
+                if(pin != uart_parity_bit(uart->uart_data, uart->parity)){
+                    uart->cb_code = UART_PARITY_ERROR;
+                    UART_STATS_ERROR(uart, uart->cb_code);
                     (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
                 }
-                hwtimer_clear_trigger_time(uart->tmr);
-                triggerable_set_trigger_enabled(uart->tmr, 0);
-
-                port_set_trigger_in_equal(uart->rx_port, 0); //Trigger on low (start of start bit)
-                triggerable_set_trigger_enabled(uart->rx_port, 1);
+                uart->state = UART_STOP;
+                break;
+            }
 
-                if(uart->uart_rx_complete_callback_arg != NULL){
-                    (*uart->uart_rx_complete_callback_arg)(uart->app_data);
+            case UART_STOP: {
+                if(pin != 1){
+                    uart->cb_code = UART_FRAMING_ERROR;
+                    UART_STATS_ERROR(uart, uart->cb_code);
+                    (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+                } else {
+                    uart->cb_code = UART_RX_COMPLETE;
                 }
+                uart->state = UART_IDLE;
+                uart->search_from = centre + 1;
+                UART_STATS_INC(uart, frames);
+                return 1;
             }
-            break;
-        }
 
-        default: {
-            xassert(0);
+            default: {
+                xassert(0);
+            }
         }
     }
 }
 
-DEFINE_INTERRUPT_CALLBACK(UART_RX_INTERRUPTABLE_FUNCTIONS, uart_rx_handle_isr, callback_info){
+/**
+ * Slides the sample window on by the next 32 samples from the port
+ */
+__attribute__((always_inline))
+static inline void uart_rx_oversampled_next_word(uart_rx_t *uart){
+    uart->samples[0] = uart->samples[1];
+    uart->samples[1] = port_in(uart->rx_port);
+    uart->sample_pos_q16 -= 32 << 16;
+    uart->search_from = uart->search_from > 32 ? uart->search_from - 32 : 0;
+}
+
+DEFINE_INTERRUPT_CALLBACK(UART_RX_INTERRUPTABLE_FUNCTIONS, uart_rx_oversampled_isr, callback_info){
     uart_rx_t *uart = (uart_rx_t *)callback_info;
-    uart_rx_handle_event(uart);
+    UART_STATS_ISR_BEGIN(uart);
+    uart_rx_oversampled_next_word(uart);
+    while(uart_rx_oversampled_decode(uart)){
+        if(uart_rx_buffer_byte(uart, UART_RX_FEATURES_ALL)){
+            (*uart->uart_rx_complete_callback_arg)(uart->app_data);
+        }
+    }
+    UART_STATS_ISR_END(uart);
 }
 
 uint8_t uart_rx(uart_rx_t *uart){
-    if(buffer_used(&uart->buffer)){
+    if(uart_ring_used(&uart->buffer)){
         uint8_t rx_data = 0;
-        uart_buffer_error_t err = pop_byte_from_buffer(&uart->buffer, &rx_data);
+        uart_buffer_error_t err = uart_ring_pop_byte(&uart->buffer, &rx_data);
         if(err == UART_BUFFER_EMPTY){
             uart->cb_code = UART_UNDERRUN_ERROR;
+            UART_STATS_ERROR(uart, uart->cb_code);
             (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
         }
+        uart_rx_check_rts_low_watermark(uart);
         return rx_data;
+    } else if(uart->clk){
+        while(!uart_rx_oversampled_decode(uart)){
+            uart_rx_oversampled_next_word(uart);
+        }
+        return uart->uart_data;
     } else {
+        return uart_rx_blocking_impl(uart, uart->num_data_bits, uart->parity, UART_RX_FEATURES_ALL);
+    }
+}
+
+uint16_t uart_rx_multidrop(uart_rx_t *uart){
+    xassert(uart->multidrop);
+    if(uart_ring_used(&uart->buffer)){
+        xassert(uart->multidrop_marks != NULL);
+        //Read first as the slot may be reused by the ISR once the word is popped
+        uint16_t mark = uart->multidrop_marks[uart->buffer.read_idx & uart->buffer.mask];
+        return (mark << 8) | uart_rx(uart);
+    }
+    uint8_t data = uart_rx(uart);
+    return (uart->uart_data & 0x100) | data;
+}
+
+uint8_t uart_rx_timestamped(uart_rx_t *uart, uint32_t *timestamp){
+    xassert(uart->timestamps != NULL);
+    //Read first as the slot may be reused by the ISR once the word is popped
+    *timestamp = uart->timestamps[uart->buffer.read_idx & uart->buffer.mask];
+    return uart_rx(uart);
+}
+
+int uart_rx_service_event(uart_rx_t *uart, uint8_t *data){
+    xassert(uart->autobaud_mode == UART_AUTOBAUD_OFF); //Autobaud needs a timer
+    if(uart->state == UART_IDLE){
+        port_in(uart->rx_port); //Completes the start edge event and timestamps it
+        port_clear_trigger_in(uart->rx_port);
+    }
+    uart_rx_handle_event_impl(uart, uart->num_data_bits, uart->parity, 0, UART_RX_FEATURES_ALL);
+    if(uart->state != UART_IDLE){
+        //The next port_in() returns the pin as it was at this time
+        port_set_trigger_time(uart->rx_port, uart->next_event_time_ticks & 0xffff);
+        return 0;
+    }
+    port_clear_trigger_time(uart->rx_port);
+    port_set_trigger_in_equal(uart->rx_port, 0); //Event on low (start of start bit)
+    if(!uart->multidrop_frame_ok){
+        return 0; //For another multidrop node
+    }
+    *data = uart->uart_data;
+    return (uart->uart_data & 0x100) ? 2 : 1;
+}
+
+uart_buffer_error_t uart_rx_read(uart_rx_t *uart, uint8_t *data, size_t n, size_t *got){
+    if(uart_ring_used(&uart->buffer)){
+        *got = uart_ring_pop(&uart->buffer, data, n);
+        uart_rx_check_rts_low_watermark(uart);
+        return (*got == n) ? UART_BUFFER_OK : UART_BUFFER_EMPTY;
+    }
+    for(size_t i = 0; i < n; i++){
+        data[i] = uart_rx(uart);
+    }
+    *got = n;
+    return UART_BUFFER_OK;
+}
+
+const uint8_t *uart_rx_peek(uart_rx_t *uart, size_t n, size_t *len){
+    xassert(uart_ring_used(&uart->buffer));
+    return uart_ring_peek(&uart->buffer, n, len);
+}
+
+void uart_rx_release(uart_rx_t *uart, size_t n){
+    uart_ring_release(&uart->buffer, n);
+    uart_rx_check_rts_low_watermark(uart);
+}
+
+void uart_rx_set_autobaud(
+        uart_rx_t *uart,
+        uart_autobaud_mode_t mode,
+        void(*uart_rx_autobaud_callback_fptr)(uint32_t baud_rate, void *app_data)){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(!uart->clk); //Timer driven modes only
+    xassert(uart->vote_ticks == 0); //The vote spacing is fixed in ticks
+    interrupt_mask_all();
+    uart->uart_rx_autobaud_callback_arg = uart_rx_autobaud_callback_fptr;
+    uart->autobaud_mode = mode;
+    if(mode == UART_AUTOBAUD_OFF && uart->state == UART_AUTOBAUD){
+        //Abandon the frame being timed and wait for the next start bit
         uart->state = UART_IDLE;
-        sleep_until_start_transition(uart);
-        do{
-            uart_rx_handle_event(uart);
-            sleep_until_next_sample(uart);
-        } while(uart->state != UART_IDLE);
+        port_set_trigger_in_equal(uart->rx_port, 0);
+    }
+    interrupt_unmask_all();
+}
 
-        return uart->uart_data;
+void uart_rx_set_majority_vote(
+        uart_rx_t *uart,
+        uint32_t spacing_ticks){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    if(spacing_ticks){
+        xassert(uart->port_timed && !uart->clk);
+        xassert(uart->autobaud_mode == UART_AUTOBAUD_OFF);
+        xassert(spacing_ticks >= UART_RX_VOTE_MIN_TICKS && spacing_ticks <= (uart->bit_time_ticks >> 2));
+    }
+    interrupt_mask_all();
+    xassert(uart->state == UART_IDLE); //Sample times are set from the start bit
+    uart->vote_ticks = spacing_ticks;
+    uart->noise_detected = 0;
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_timestamps(
+        uart_rx_t *uart,
+        uint32_t *timestamps,
+        size_t num_timestamps){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(uart_ring_used(&uart->buffer) && !uart->clk);
+    xassert(timestamps == NULL || num_timestamps >= uart_ring_capacity(&uart->buffer));
+    xassert(uart->deframer.type == UART_FRAMING_NONE && !uart->stream_chanend);
+    interrupt_mask_all();
+    xassert(uart->state == UART_IDLE);
+    //The port timer runs from the reference clock, so the offset is fixed. An
+    //unconditional input timestamps now
+    port_clear_trigger_in(uart->rx_port);
+    port_in(uart->rx_port);
+    uart->port_time_offset = uart_rx_get_current_time(uart) - port_get_trigger_time(uart->rx_port);
+    port_set_trigger_in_equal(uart->rx_port, 0); //Back to waiting for the start bit
+    uart->timestamps = timestamps;
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_framing(
+        uart_rx_t *uart,
+        uart_framing_t framing,
+        uint8_t *packet,
+        size_t packet_size,
+        uint8_t *(*uart_rx_packet_callback_fptr)(uint8_t *packet, size_t len, void *app_data)){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(uart_ring_used(&uart->buffer)); //Packets are decoded in the ISR
+    xassert(uart->timestamps == NULL && !uart->stream_chanend);
+    xassert(framing == UART_FRAMING_NONE || (packet != NULL && uart_rx_packet_callback_fptr != NULL));
+    interrupt_mask_all();
+    uart->uart_rx_packet_callback_arg = uart_rx_packet_callback_fptr;
+    uart_deframer_init(&uart->deframer, framing, packet, packet_size);
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_streaming(
+        uart_rx_t *uart,
+        chanend_t c){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(uart_ring_used(&uart->buffer)); //Words are streamed from the ISR
+    xassert(uart->deframer.type == UART_FRAMING_NONE && uart->timestamps == NULL);
+    interrupt_mask_all();
+    if(uart->stream_chanend){
+        uart_rx_stream_flush(uart);
     }
+    uart->stream_word = 0;
+    uart->stream_count = 0;
+    uart->stream_chanend = c;
+    interrupt_unmask_all();
+}
+
+size_t uart_rx_stream_in(
+        chanend_t c,
+        uint8_t *data){
+
+    //Position of the first control token in the next word, counting from 1, or 0 for none
+    int ct_pos = chanend_test_control_token_next_word(c);
+    if(ct_pos == 0){
+        uint32_t word = s_chan_in_word(c);
+        for(int i = 0; i < 4; i++){
+            data[i] = word >> (8 * i);
+        }
+        return 4;
+    }
+    for(int i = 0; i < ct_pos - 1; i++){
+        data[i] = s_chan_in_byte(c);
+    }
+    s_chan_check_ct_end(c);
+    return ct_pos - 1;
+}
+
+void uart_rx_set_crc(
+        uart_rx_t *uart,
+        const uart_crc_t *crc){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(uart_ring_used(&uart->buffer)); //The CRC is run in the ISR
+    interrupt_mask_all();
+    if(crc != NULL){
+        uart->crc = *crc;
+        uart_crc_reset(&uart->crc);
+    } else {
+        uart->crc.width = 0;
+    }
+    uart->packet_crc = 0;
+    interrupt_unmask_all();
+}
+
+uint32_t uart_rx_get_packet_crc(uart_rx_t *uart){
+    return uart->packet_crc;
+}
+
+void uart_rx_set_multidrop(
+        uart_rx_t *uart,
+        uint8_t address,
+        uint8_t mask,
+        uint8_t *marks,
+        size_t num_marks){
+
+    xassert(!uart->specialised); //The frame format is fixed by UART_RX_DEFINE()
+    xassert(!uart->clk); //Timer driven modes only
+    xassert(uart->num_data_bits == 8 && uart->parity == UART_PARITY_NONE);
+    xassert(marks == NULL || (uart_ring_used(&uart->buffer) && num_marks >= uart_ring_capacity(&uart->buffer)));
+    interrupt_mask_all();
+    uart->multidrop_marks = marks;
+    uart->num_data_bits = 9;
+    uart->multidrop_address = address;
+    uart->multidrop_mask = mask;
+    uart->multidrop_selected = 0;
+    uart->multidrop = 1;
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_rts(
+        uart_rx_t *uart,
+        port_t rts_port,
+        uint32_t high_watermark,
+        uint32_t low_watermark){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(uart_ring_used(&uart->buffer));
+    xassert(low_watermark < high_watermark && high_watermark <= uart_ring_capacity(&uart->buffer));
+    port_enable(rts_port);
+    interrupt_mask_all();
+    uart->rts_high_watermark = high_watermark;
+    uart->rts_low_watermark = low_watermark;
+    uart->rts_deasserted = 0;
+    uart->rts_port = rts_port;
+    port_out(rts_port, 0); //Ready to receive
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_high_watermark(
+        uart_rx_t *uart,
+        uint32_t high_watermark,
+        void(*uart_rx_high_watermark_callback_fptr)(void* app_data)){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    xassert(high_watermark == 0 || uart_rx_high_watermark_callback_fptr != NULL);
+    xassert(high_watermark <= uart_ring_capacity(&uart->buffer));
+    interrupt_mask_all();
+    uart->uart_rx_high_watermark_callback_arg = uart_rx_high_watermark_callback_fptr;
+    uart->high_watermark = high_watermark;
+    interrupt_unmask_all();
+}
+
+void uart_rx_set_idle_timeout(
+        uart_rx_t *uart,
+        uint32_t idle_bits,
+        void(*uart_rx_idle_callback_fptr)(size_t num_bytes, void *app_data)){
+
+    xassert(!uart->specialised); //Folded out of UART_RX_DEFINE()
+    //Needs the timer driven buffered mode since the timer does the timing
+    xassert(uart_ring_used(&uart->buffer) && uart->tmr && !uart->clk);
+    xassert(idle_bits == 0 || uart_rx_idle_callback_fptr != NULL || uart->stream_chanend);
+
+    interrupt_mask_all();
+    uart->idle_timeout_ticks = idle_bits * uart->bit_time_ticks;
+    uart->idle_byte_count = 0;
+    uart->uart_rx_idle_callback_arg = uart_rx_idle_callback_fptr;
+    if(idle_bits){
+        triggerable_setup_interrupt_callback(uart->tmr, uart, INTERRUPT_CALLBACK(uart_rx_idle_isr) );
+    } else {
+        triggerable_setup_interrupt_callback(uart->tmr, uart, INTERRUPT_CALLBACK(uart_rx_handle_isr) );
+        if(uart->state == UART_IDLE){
+            triggerable_set_trigger_enabled(uart->tmr, 0); //Cancel any pending timeout
+        }
+    }
+    interrupt_unmask_all();
+}
+
+void uart_rx_get_stats(
+        uart_rx_t *uart,
+        uart_stats_t *stats){
+
+    interrupt_mask_all();
+    UART_STATS_SNAPSHOT(uart, stats);
+    interrupt_unmask_all();
+}
+
+void uart_rx_reset_stats(uart_rx_t *uart){
+    interrupt_mask_all();
+    UART_STATS_RESET(uart);
+    interrupt_unmask_all();
 }
 
 void uart_rx_deinit(uart_rx_t *uart){
     interrupt_mask_all();
-    if(buffer_used(&uart->buffer)){        
+    if(uart_ring_used(&uart->buffer)){        
         triggerable_set_trigger_enabled(uart->rx_port, 0);
-        triggerable_set_trigger_enabled(uart->tmr, 0);
+        if(uart->tmr){
+            triggerable_set_trigger_enabled(uart->tmr, 0);
+        }
+    }
+    if(uart->clk){
+        clock_stop(uart->clk);
+        clock_disable(uart->clk);
+    }
+    if(uart->rts_port){
+        port_disable(uart->rts_port);
     }
     port_disable(uart->rx_port);
     interrupt_unmask_all();
 }
-
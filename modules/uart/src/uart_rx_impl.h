@@ -0,0 +1,544 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/**
+ * This file contains the timer driven UART Rx state machine. It is inlined into
+ * the generic ISR in uart_rx.c and into the specialised ones from UART_RX_DEFINE().
+ */
+
+#pragma once
+#include <stdint.h>
+#include <xcore/assert.h>
+#include <xcore/port.h>
+#include <xcore/hwtimer.h>
+#include <xcore/triggerable.h>
+
+#include "uart.h"
+#include "uart_frame.h"
+#include "uart_stats.h"
+
+/**
+ * The runtime features the state machine checks for. The generic ISR and calls
+ * pass UART_RX_FEATURES_ALL, and UART_RX_DEFINE() passes none so the checks fold
+ * away. A specialised UART Rx asserts if any of these are enabled on it.
+ */
+#define UART_RX_FEATURE_AUTOBAUD        (1 << 0)
+#define UART_RX_FEATURE_VOTE            (1 << 1)
+#define UART_RX_FEATURE_TIMESTAMPS      (1 << 2)
+#define UART_RX_FEATURE_MULTIDROP       (1 << 3)
+#define UART_RX_FEATURE_FRAMING         (1 << 4)
+#define UART_RX_FEATURE_STREAM          (1 << 5)
+#define UART_RX_FEATURE_CRC             (1 << 6)
+#define UART_RX_FEATURE_WATERMARK       (1 << 7)
+#define UART_RX_FEATURE_RTS             (1 << 8)
+#define UART_RX_FEATURE_IDLE_TIMEOUT    (1 << 9)
+#define UART_RX_FEATURES_ALL            0xffffffff
+
+#define UART_RX_DEBUG 0 //Drives debug port for checking state timing in simulator
+#if UART_RX_DEBUG
+extern port_t p_dbg;
+#endif
+
+__attribute__((always_inline))
+static inline uint32_t uart_rx_get_current_time(uart_rx_t *uart){
+    // if(uart->tmr){
+    //     return hwtimer_get_time(uart->tmr);
+    // }
+    //Note this has now been optimised since all timers share the same physical timer counter
+    return get_reference_time();
+}
+
+//The width is a 16b port timer difference so rates below about 1526 baud wrap
+static const uint32_t uart_standard_baud_rates[] = {
+    2400, 4800, 9600, 14400, 19200, 28800, 38400, 57600,
+    115200, 230400, 250000, 460800, 500000, 921600, 1000000, 1500000, 2000000
+};
+
+/**
+ * Sets the bit time from the measured start bit width, in reference clock ticks,
+ * and returns the resulting baud rate. Autobaud is one shot so it is disarmed.
+ */
+static inline uint32_t uart_rx_autobaud_apply(uart_rx_t *uart, uint32_t width_ticks){
+    uint32_t baud_rate = 0;
+    if(uart->autobaud_mode == UART_AUTOBAUD_SNAP){
+        uint32_t best_err = 0xffffffff;
+        for(int i = 0; i < sizeof(uart_standard_baud_rates) / sizeof(uart_standard_baud_rates[0]); i++){
+            uint32_t ticks = XS1_TIMER_HZ / uart_standard_baud_rates[i];
+            uint32_t err = ticks > width_ticks ? ticks - width_ticks : width_ticks - ticks;
+            if(err < best_err){
+                best_err = err;
+                baud_rate = uart_standard_baud_rates[i];
+            }
+        }
+        uart->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+        uart->bit_time_frac = uart_bit_time_frac(baud_rate);
+    } else {
+        uart->bit_time_ticks = width_ticks;
+        uart->bit_time_frac = 0;
+        baud_rate = XS1_TIMER_HZ / width_ticks;
+    }
+    uart->port_timed = uart->bit_time_ticks < 0x8000;
+    uart->autobaud_mode = UART_AUTOBAUD_OFF;
+    return baud_rate;
+}
+
+__attribute__((always_inline))
+static inline void uart_rx_sleep_until_start_transition(uart_rx_t *uart){
+    if(uart->port_timed){
+        port_clear_trigger_time(uart->rx_port); //Left set by the last sample
+    }
+    if(uart->tmr){
+        //Wait on a port transition to low
+        port_in_when_pinseq(uart->rx_port, PORT_UNBUFFERED, 0);
+    }else{
+        //Poll the port
+        while(port_in(uart->rx_port) & 0x1);
+    }
+}
+
+__attribute__((always_inline))
+static inline void uart_rx_sleep_until_next_sample(uart_rx_t *uart){
+    if(uart->port_timed){
+        //The next port_in() waits for the port timer and returns the pin at that time
+        port_set_trigger_time(uart->rx_port, uart->next_event_time_ticks & 0xffff);
+    }else if(uart->tmr){
+        //Wait on a the timer
+        hwtimer_wait_until(uart->tmr, uart->next_event_time_ticks);
+    }else{
+        //Poll the timer
+        while(uart_rx_get_current_time(uart) < uart->next_event_time_ticks);
+    }
+}
+
+// Interrupt latency and calling overhead has been measured at 510ns @ 75-120MHz thread speed 
+// Latency for polling/timer wait mode is around 320ns @ 75-120MHz thread speed   
+// These values have been experimentally derived using xsim (See enabling of debug in test_rx_uart.py)
+// and then inspecting the VCD waveform to see where the start bit samples in relation 
+// to the falling edge of the start bit. Turn on debug mode and observe p_dbg
+
+#define UART_RX_INTERRUPT_LATENCY_COMPENSATION_TICKS (XS1_TIMER_MHZ * 510 / 1000)
+#define UART_RX_BLOCKING_LATENCY_COMPENSATION_TICKS  (XS1_TIMER_MHZ * 320 / 1000)
+
+
+/**
+ * Decides whether the frame just received is kept. Address frames select or
+ * deselect this node, and data frames are kept while it is selected.
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_rx_multidrop_accept(uart_rx_t *uart, const uint32_t features){
+    if(!(features & UART_RX_FEATURE_MULTIDROP)){
+        return 1;
+    }
+    if(uart->multidrop){
+        if(uart->uart_data & 0x100){
+            uart->multidrop_selected = ((uart->uart_data ^ uart->multidrop_address) & uart->multidrop_mask) == 0;
+        }
+        uart->multidrop_frame_ok = uart->multidrop_selected;
+    }
+    return uart->multidrop_frame_ok;
+}
+
+/**
+ * Called by the ISR after each successful push. The fill level only rises by
+ * pushing, so it passes through the watermark exactly once per fill.
+ */
+__attribute__((always_inline))
+static inline void uart_rx_check_high_watermark(uart_rx_t *uart, const uint32_t features){
+    if((features & UART_RX_FEATURE_WATERMARK) && uart->high_watermark &&
+       uart_ring_fill_level(&uart->buffer) == uart->high_watermark){
+        (*uart->uart_rx_high_watermark_callback_arg)(uart->app_data);
+    }
+    UART_STATS_HIGH_WATER(uart, uart_ring_fill_level(&uart->buffer));
+    if((features & UART_RX_FEATURE_RTS) && uart->rts_port && !uart->rts_deasserted &&
+       uart_ring_fill_level(&uart->buffer) >= uart->rts_high_watermark){
+        port_out(uart->rts_port, 1); //Ask the far end to stop
+        uart->rts_deasserted = 1;
+    }
+}
+
+/**
+ * Returns the reference time of a 16b Rx port time in the recent past
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_rx_port_to_ref_time(uart_rx_t *uart, uint32_t port_time){
+    uint32_t now = uart_rx_get_current_time(uart);
+    return now - (((now - uart->port_time_offset) - port_time) & 0xffff);
+}
+
+/**
+ * Stores a received byte in buffered mode, either in the Rx buffer, in the
+ * packet being decoded or in the word being streamed. Returns non-zero if the
+ * complete callback should be called, which is only done for the Rx buffer.
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_rx_buffer_byte(uart_rx_t *uart, const uint32_t features){
+    if((features & UART_RX_FEATURE_FRAMING) && uart->deframer.type != UART_FRAMING_NONE){
+        size_t pos = uart->deframer.pos;
+        uart_deframe_result_t res = uart_deframer_push(&uart->deframer, uart->uart_data);
+        if((features & UART_RX_FEATURE_CRC) && uart->crc.width && uart->deframer.pos > pos){
+            //Each received byte decodes to at most one packet byte
+            uart_crc_update(&uart->crc, uart->deframer.packet[pos]);
+        }
+        if(res == UART_DEFRAME_PACKET){
+            if((features & UART_RX_FEATURE_CRC) && uart->crc.width){
+                uart->packet_crc = uart_crc_result(&uart->crc);
+                uart_crc_reset(&uart->crc);
+            }
+            uint8_t *next = (*uart->uart_rx_packet_callback_arg)(uart->deframer.packet, uart->deframer.len, uart->app_data);
+            uart_deframer_set_packet(&uart->deframer, next);
+        } else if(res == UART_DEFRAME_ERROR){
+            uart_crc_reset(&uart->crc);
+            uart->cb_code = UART_PACKET_ERROR;
+            UART_STATS_ERROR(uart, uart->cb_code);
+            (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+        }
+        return 0;
+    }
+
+    if((features & UART_RX_FEATURE_CRC) && uart->crc.width){
+        uart_crc_update(&uart->crc, uart->uart_data);
+    }
+
+    if((features & UART_RX_FEATURE_STREAM) && uart->stream_chanend){
+        uart->stream_word |= (uint32_t)(uint8_t)uart->uart_data << (8 * uart->stream_count);
+        uart->stream_count += 1;
+        if(uart->stream_count == 4){
+            s_chan_out_word(uart->stream_chanend, uart->stream_word);
+            uart->stream_word = 0;
+            uart->stream_count = 0;
+        }
+        return 0;
+    }
+
+    if((features & UART_RX_FEATURE_TIMESTAMPS) && uart->timestamps != NULL &&
+       uart_ring_fill_level(&uart->buffer) <= uart->buffer.mask){
+        //Written before the push so the word is never seen without its timestamp
+        uart->timestamps[uart->buffer.write_idx & uart->buffer.mask] = uart->edge_time_ticks;
+    }
+    if((features & UART_RX_FEATURE_MULTIDROP) && uart->multidrop_marks != NULL &&
+       uart_ring_fill_level(&uart->buffer) <= uart->buffer.mask){
+        //The buffer is 8b wide so the address mark goes alongside, written first like the timestamp
+        uart->multidrop_marks[uart->buffer.write_idx & uart->buffer.mask] = uart->uart_data >> 8;
+    }
+    uart_buffer_error_t err = uart_ring_push_byte(&uart->buffer, uart->uart_data);
+    if(err == UART_BUFFER_FULL){
+        uart->cb_code = UART_OVERRUN_ERROR;
+        UART_STATS_ERROR(uart, uart->cb_code);
+        (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+    } else {
+        uart_rx_check_high_watermark(uart, features);
+    }
+    return uart->uart_rx_complete_callback_arg != NULL;
+}
+
+/**
+ * Takes the sample of the current bit. With majority voting this is the first
+ * of three samples and the other two are timed inputs taken here, so they
+ * need no events of their own.
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_rx_sample(uart_rx_t *uart, const uint32_t features){
+    uint32_t pin = port_in(uart->rx_port) & 0x1;
+    if((features & UART_RX_FEATURE_VOTE) && uart->vote_ticks){
+        uint32_t t = uart->next_event_time_ticks;
+        port_set_trigger_time(uart->rx_port, (t + uart->vote_ticks) & 0xffff);
+        uint32_t votes = pin + (port_in(uart->rx_port) & 0x1);
+        port_set_trigger_time(uart->rx_port, (t + 2 * uart->vote_ticks) & 0xffff);
+        votes += port_in(uart->rx_port) & 0x1;
+        if(votes == 1 || votes == 2){
+            uart->noise_detected = 1;
+        }
+        pin = votes >> 1;
+    }
+    return pin;
+}
+
+/**
+ * Moves on to the centre of the next bit. In buffered mode the next sample is
+ * either a port time event, which latches the pin exactly on time however late
+ * the ISR runs, or a timer event.
+ */
+__attribute__((always_inline))
+static inline void uart_rx_next_sample(uart_rx_t *uart, const int buffered){
+    uart->next_event_time_ticks += uart_next_bit_ticks(&uart->bit_time_acc, uart->bit_time_ticks, uart->bit_time_frac);
+    if(buffered){
+        if(uart->port_timed){
+            port_set_trigger_time(uart->rx_port, uart->next_event_time_ticks & 0xffff);
+        } else {
+            hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
+        }
+    }
+}
+
+/**
+ * Runs one step of the Rx state machine. The frame format, mode and runtime
+ * features are passed in so that when they are constants the parity, buffer
+ * and feature checks fold away. See UART_RX_DEFINE().
+ */
+__attribute__((always_inline))
+static inline void uart_rx_handle_event_impl(
+        uart_rx_t *uart,
+        const uint32_t num_data_bits,
+        const uart_parity_t parity,
+        const int buffered,
+        const uint32_t features){
+
+    switch(uart->state){
+        case UART_IDLE: {
+            #if UART_RX_DEBUG
+            port_out(p_dbg, uart->state);
+            #endif
+
+            if((features & UART_RX_FEATURE_AUTOBAUD) && uart->autobaud_mode != UART_AUTOBAUD_OFF){
+                //Buffered only. Timestamp the falling edge then wait for the end of the start bit
+                port_in(uart->rx_port);
+                uart->autobaud_edge_time = port_get_trigger_time(uart->rx_port);
+                if((features & UART_RX_FEATURE_TIMESTAMPS) && uart->timestamps != NULL){
+                    uart->edge_time_ticks = uart_rx_port_to_ref_time(uart, uart->autobaud_edge_time);
+                }
+                port_set_trigger_in_equal(uart->rx_port, 1);
+                triggerable_set_trigger_enabled(uart->tmr, 0); //No idle timeout mid frame
+                uart->state = UART_AUTOBAUD;
+                break;
+            }
+            if(uart->port_timed){
+                //Time from the port timestamp of the falling edge so ISR latency does not matter
+                if(buffered){
+                    port_in(uart->rx_port); //Completes the edge event. Blocking mode did this already
+                }
+                uart->next_event_time_ticks = port_get_trigger_time(uart->rx_port);
+            } else {
+                uart->next_event_time_ticks = uart_rx_get_current_time(uart);
+            }
+            if(buffered && (features & UART_RX_FEATURE_TIMESTAMPS) && uart->timestamps != NULL){
+                uart->edge_time_ticks = uart->port_timed ?
+                    uart_rx_port_to_ref_time(uart, uart->next_event_time_ticks) : uart->next_event_time_ticks;
+            }
+            uart->next_event_time_ticks += uart->bit_time_ticks >> 1; //Halfway through start bit
+            if(features & UART_RX_FEATURE_VOTE){
+                uart->next_event_time_ticks -= uart->vote_ticks; //Less the first vote
+            }
+            uart->bit_time_acc = ((uart->bit_time_ticks & 1) << 15) + (uart->bit_time_frac >> 1); //And the other half tick
+            uart->state = UART_START;
+            if(buffered && uart->port_timed){
+                //The port stays the ISR source, now on time rather than pin value
+                port_clear_trigger_in(uart->rx_port);
+                port_set_trigger_time(uart->rx_port, uart->next_event_time_ticks & 0xffff);
+                triggerable_set_trigger_enabled(uart->tmr, 0); //No idle timeout mid frame
+            } else if(buffered){
+                uart->next_event_time_ticks -= UART_RX_INTERRUPT_LATENCY_COMPENSATION_TICKS;
+                triggerable_set_trigger_enabled(uart->rx_port, 0);
+                port_clear_trigger_in(uart->rx_port);
+                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
+                triggerable_set_trigger_enabled(uart->tmr, 1);
+            } else if(!uart->port_timed){
+                uart->next_event_time_ticks -= UART_RX_BLOCKING_LATENCY_COMPENSATION_TICKS;
+            }
+            break;
+        }
+
+        case UART_START: {
+            #if UART_RX_DEBUG
+            port_out(p_dbg, uart->state);
+            #endif
+
+            uint32_t pin = uart_rx_sample(uart, features);
+            if(pin != 0){
+                uart->cb_code = UART_START_BIT_ERROR;
+                UART_STATS_ERROR(uart, uart->cb_code);
+                (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+            }
+            uart->state = UART_DATA;
+            uart->uart_data = 0;
+            uart->current_data_bit = 0;
+            uart_rx_next_sample(uart, buffered);
+            break;
+        }
+
+        case UART_DATA: { 
+            #if UART_RX_DEBUG
+            port_out(p_dbg, uart->state);
+            #endif
+
+            uint32_t pin = uart_rx_sample(uart, features);
+            uart->uart_data |= pin << uart->current_data_bit;
+            uart->current_data_bit += 1;
+
+            if(uart->current_data_bit == num_data_bits){
+                if(parity == UART_PARITY_NONE){
+                    uart->state = UART_STOP;
+                } else {
+                    uart->state = UART_PARITY;
+                }
+            }
+            uart_rx_next_sample(uart, buffered);
+            break;
+        }
+
+        case UART_PARITY: {
+            #if UART_RX_DEBUG
+            port_out(p_dbg, uart->state);
+            #endif
+
+            uint32_t pin = uart_rx_sample(uart, features);
+            if(pin != uart_parity_bit(uart->uart_data, parity)){
+                uart->cb_code = UART_PARITY_ERROR;
+                UART_STATS_ERROR(uart, uart->cb_code);
+                (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+            }
+            uart->state = UART_STOP;
+            uart_rx_next_sample(uart, buffered);
+            break;
+        }
+     
+        case UART_STOP: {
+            #if UART_RX_DEBUG
+            port_out(p_dbg, uart->state);
+            #endif
+
+            uint32_t pin = uart_rx_sample(uart, features);
+            uint32_t accepted = uart_rx_multidrop_accept(uart, features);
+            if(accepted){
+                UART_STATS_INC(uart, frames);
+            }
+            if(pin != 1){
+                uart->cb_code = UART_FRAMING_ERROR;
+                if(accepted){
+                    UART_STATS_ERROR(uart, uart->cb_code);
+                    (*uart->uart_rx_error_callback_arg)(uart->cb_code, uart->app_data);
+                }
+            } else {
+                uart->cb_code = UART_RX_COMPLETE;
+            }
+            if((features & UART_RX_FEATURE_VOTE) && uart->noise_detected){
+                uart->noise_detected = 0;
+                if(accepted){
+                    UART_STATS_ERROR(uart, UART_NOISE_ERROR);
+                    (*uart->uart_rx_error_callback_arg)(UART_NOISE_ERROR, uart->app_data);
+                }
+            }
+            uart->state = UART_IDLE;
+
+            //Go back to waiting for next start bit transition
+            if(buffered){
+                uint32_t notify = 0;
+                if(accepted){
+                    notify = uart_rx_buffer_byte(uart, features);
+                    uart->idle_byte_count += 1;
+                }
+                if((features & UART_RX_FEATURE_IDLE_TIMEOUT) && uart->idle_timeout_ticks){
+                    //Timer stays on to time the idle line from the end of the stop bit
+                    uint32_t stop_end = uart->port_timed ? uart_rx_get_current_time(uart) : uart->next_event_time_ticks;
+                    stop_end += uart->bit_time_ticks >> 1;
+                    hwtimer_set_trigger_time(uart->tmr, stop_end + uart->idle_timeout_ticks);
+                    triggerable_set_trigger_enabled(uart->tmr, 1);
+                } else {
+                    hwtimer_clear_trigger_time(uart->tmr);
+                    triggerable_set_trigger_enabled(uart->tmr, 0);
+                }
+
+                if(uart->port_timed){
+                    port_clear_trigger_time(uart->rx_port);
+                }
+                port_set_trigger_in_equal(uart->rx_port, 0); //Trigger on low (start of start bit)
+                triggerable_set_trigger_enabled(uart->rx_port, 1);
+
+                if(notify){
+                    (*uart->uart_rx_complete_callback_arg)(uart->app_data);
+                }
+            }
+            break;
+        }
+
+        case UART_AUTOBAUD: {
+            if(!(features & UART_RX_FEATURE_AUTOBAUD)){
+                xassert(0); //Only entered with autobaud armed
+                break;
+            }
+            //Buffered only. The rising edge at the end of the start bit, so we are at the start of bit 0
+            port_in(uart->rx_port);
+            uint16_t width = port_get_trigger_time(uart->rx_port) - uart->autobaud_edge_time;
+            uint32_t baud_rate = uart_rx_autobaud_apply(uart, width);
+
+            uart->bit_time_acc = ((uart->bit_time_ticks & 1) << 15) + (uart->bit_time_frac >> 1);
+            uart->state = UART_DATA;
+            uart->uart_data = 0;
+            uart->current_data_bit = 0;
+            port_clear_trigger_in(uart->rx_port);
+            if(uart->port_timed){
+                uart->next_event_time_ticks = port_get_trigger_time(uart->rx_port) + (uart->bit_time_ticks >> 1);
+                port_set_trigger_time(uart->rx_port, uart->next_event_time_ticks & 0xffff);
+            } else {
+                uart->next_event_time_ticks = uart_rx_get_current_time(uart);
+                uart->next_event_time_ticks += (uart->bit_time_ticks >> 1) - UART_RX_INTERRUPT_LATENCY_COMPENSATION_TICKS;
+                triggerable_set_trigger_enabled(uart->rx_port, 0);
+                hwtimer_set_trigger_time(uart->tmr, uart->next_event_time_ticks);
+                triggerable_set_trigger_enabled(uart->tmr, 1);
+            }
+
+            if(uart->uart_rx_autobaud_callback_arg != NULL){
+                (*uart->uart_rx_autobaud_callback_arg)(baud_rate, uart->app_data);
+            }
+            break;
+        }
+
+        default: {
+            xassert(0);
+        }
+    }
+}
+
+/**
+ * Receives one frame in the calling thread. With autobaud armed the frame is
+ * timed from its start bit instead.
+ */
+__attribute__((always_inline))
+static inline uint8_t uart_rx_blocking_impl(
+        uart_rx_t *uart,
+        const uint32_t num_data_bits,
+        const uart_parity_t parity,
+        const uint32_t features){
+
+    if((features & UART_RX_FEATURE_AUTOBAUD) && uart->autobaud_mode != UART_AUTOBAUD_OFF){
+        //Time the start bit edge to edge then carry on from the start of bit 0
+        if(uart->port_timed){
+            port_clear_trigger_time(uart->rx_port);
+        }
+        port_in_when_pinseq(uart->rx_port, PORT_UNBUFFERED, 0);
+        uart->autobaud_edge_time = port_get_trigger_time(uart->rx_port);
+        port_in_when_pinseq(uart->rx_port, PORT_UNBUFFERED, 1);
+        uint16_t width = port_get_trigger_time(uart->rx_port) - uart->autobaud_edge_time;
+        uint32_t baud_rate = uart_rx_autobaud_apply(uart, width);
+
+        if(uart->port_timed){
+            uart->next_event_time_ticks = port_get_trigger_time(uart->rx_port) + (uart->bit_time_ticks >> 1);
+        } else {
+            uart->next_event_time_ticks = uart_rx_get_current_time(uart);
+            uart->next_event_time_ticks += (uart->bit_time_ticks >> 1) - UART_RX_BLOCKING_LATENCY_COMPENSATION_TICKS;
+        }
+        uart->bit_time_acc = ((uart->bit_time_ticks & 1) << 15) + (uart->bit_time_frac >> 1);
+        uart->state = UART_DATA;
+        uart->uart_data = 0;
+        uart->current_data_bit = 0;
+        if(uart->uart_rx_autobaud_callback_arg != NULL){
+            (*uart->uart_rx_autobaud_callback_arg)(baud_rate, uart->app_data);
+        }
+        do{
+            uart_rx_sleep_until_next_sample(uart);
+            uart_rx_handle_event_impl(uart, num_data_bits, parity, 0, features);
+        } while(uart->state != UART_IDLE);
+
+        return uart->uart_data;
+    }
+
+    do{
+        uart->state = UART_IDLE;
+        uart_rx_sleep_until_start_transition(uart);
+        do{
+            uart_rx_handle_event_impl(uart, num_data_bits, parity, 0, features);
+            uart_rx_sleep_until_next_sample(uart);
+        } while(uart->state != UART_IDLE);
+    } while((features & UART_RX_FEATURE_MULTIDROP) && !uart->multidrop_frame_ok); //Skip frames for other multidrop nodes
+
+    return uart->uart_data;
+}
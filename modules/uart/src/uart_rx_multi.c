@@ -0,0 +1,190 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <xclib.h>
+#include <xcore/assert.h>
+
+#include "uart.h"
+#include "uart_frame.h"
+
+#define UART_RX_MULTI_MAX_DIVIDE    255
+
+void uart_rx_multi_init(
+        uart_rx_multi_t *ctx,
+        port_t rx_port,
+        uint32_t port_width,
+        xclock_t clk,
+        uint32_t sample_rate){
+
+    xassert(port_width == 4 || port_width == 8);
+    uint32_t divide = (XS1_TIMER_HZ / 2) / sample_rate;
+    xassert(divide >= 1 && divide <= UART_RX_MULTI_MAX_DIVIDE);
+
+    ctx->rx_port = rx_port;
+    ctx->clk = clk;
+    ctx->port_width = port_width;
+    ctx->sample_rate = (XS1_TIMER_HZ / 2) / divide;
+    ctx->line_mask = 0;
+    ctx->idle_mask = 0;
+    ctx->prev_sample = 0; //A line must be seen high before its first start bit is accepted
+
+    clock_enable(clk);
+    clock_set_source_clk_ref(clk);
+    clock_set_divide(clk, divide);
+
+    port_start_buffered(rx_port, 32);
+    port_set_clock(rx_port, clk);
+}
+
+void uart_rx_multi_line_init(
+        uart_rx_multi_t *ctx,
+        unsigned line,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_rx_complete_callback_fptr)(void *app_data),
+        void(*uart_rx_error_callback_fptr)(uart_callback_code_t callback_code, void *app_data),
+        void *app_data
+        ){
+
+    xassert(line < ctx->port_width);
+    xassert(num_data_bits <= 8 && num_data_bits >= 5);
+    xassert(parity == UART_PARITY_NONE || parity == UART_PARITY_EVEN || parity == UART_PARITY_ODD);
+    xassert(buffer != NULL);
+    (void)stop_bits; //As for uart_rx, only the first stop bit is checked
+
+    uart_rx_multi_line_t *l = &ctx->line[line];
+    l->state = UART_IDLE;
+    l->samples_per_bit_q16 = ((uint64_t)ctx->sample_rate << 16) / baud_rate;
+    xassert(l->samples_per_bit_q16 >= (4 << 16)); //Need at least 4 samples per bit to find the centre
+    l->countdown_q16 = 0;
+    l->parity = parity;
+    l->num_data_bits = num_data_bits;
+    l->current_data_bit = 0;
+    l->uart_data = 0;
+    l->cb_code = UART_RX_COMPLETE;
+    l->uart_rx_complete_callback_arg = uart_rx_complete_callback_fptr;
+    l->uart_rx_error_callback_arg = uart_rx_error_callback_fptr;
+    l->app_data = app_data;
+    uart_ring_init(&l->buffer, buffer, buffer_size_plus_one);
+
+    ctx->line_mask |= 1 << line;
+    ctx->idle_mask |= 1 << line;
+}
+
+/**
+ * Runs the frame state machine of one line at the centre of a bit.
+ * Returns non-zero when the line has gone back to idle.
+ */
+__attribute__((always_inline))
+static inline int uart_rx_multi_line_bit(uart_rx_multi_line_t *l, uint32_t pin){
+    switch(l->state){
+        case UART_START: {
+            if(pin != 0){
+                l->cb_code = UART_START_BIT_ERROR;
+                (*l->uart_rx_error_callback_arg)(l->cb_code, l->app_data);
+            }
+            l->state = UART_DATA;
+            l->uart_data = 0;
+            l->current_data_bit = 0;
+            break;
+        }
+
+        case UART_DATA: {
+            l->uart_data |= pin << l->current_data_bit;
+            l->current_data_bit += 1;
+            if(l->current_data_bit == l->num_data_bits){
+                l->state = (l->parity == UART_PARITY_NONE) ? UART_STOP : UART_PARITY;
+            }
+            break;
+        }
+
+        case UART_PARITY: {
+            if(pin != uart_parity_bit(l->uart_data, l->parity)){
+                l->cb_code = UART_PARITY_ERROR;
+                (*l->uart_rx_error_callback_arg)(l->cb_code, l->app_data);
+            }
+            l->state = UART_STOP;
+            break;
+        }
+
+        case UART_STOP: {
+            if(pin != 1){
+                l->cb_code = UART_FRAMING_ERROR;
+                (*l->uart_rx_error_callback_arg)(l->cb_code, l->app_data);
+            } else {
+                l->cb_code = UART_RX_COMPLETE;
+            }
+            l->state = UART_IDLE;
+
+            uart_buffer_error_t err = uart_ring_push_byte(&l->buffer, l->uart_data);
+            if(err == UART_BUFFER_FULL){
+                l->cb_code = UART_OVERRUN_ERROR;
+                (*l->uart_rx_error_callback_arg)(l->cb_code, l->app_data);
+            }
+            if(l->uart_rx_complete_callback_arg != NULL){
+                (*l->uart_rx_complete_callback_arg)(l->app_data);
+            }
+            return 1;
+        }
+
+        default: {
+            xassert(0);
+        }
+    }
+    return 0;
+}
+
+__attribute__((always_inline))
+static inline void uart_rx_multi_sample(uart_rx_multi_t *ctx, uint32_t sample){
+    //Falling edges on idle lines are found for all lines at once
+    uint32_t starts = ctx->idle_mask & ctx->prev_sample & ~sample;
+    uint32_t active = ctx->line_mask & ~ctx->idle_mask;
+    ctx->prev_sample = sample;
+
+    while(active){
+        unsigned line = 31 - clz(active);
+        active &= ~(1 << line);
+        uart_rx_multi_line_t *l = &ctx->line[line];
+        l->countdown_q16 -= (1 << 16);
+        if(l->countdown_q16 <= 0){
+            l->countdown_q16 += l->samples_per_bit_q16;
+            if(uart_rx_multi_line_bit(l, (sample >> line) & 0x1)){
+                ctx->idle_mask |= 1 << line;
+            }
+        }
+    }
+
+    while(starts){
+        unsigned line = 31 - clz(starts);
+        starts &= ~(1 << line);
+        uart_rx_multi_line_t *l = &ctx->line[line];
+        //This is the first low sample so the centre of the start bit is half a bit away
+        l->countdown_q16 = l->samples_per_bit_q16 >> 1;
+        l->state = UART_START;
+        ctx->idle_mask &= ~(1 << line);
+    }
+}
+
+void uart_rx_multi(uart_rx_multi_t *ctx){
+    const uint32_t width = ctx->port_width;
+    const uint32_t sample_mask = (1 << width) - 1;
+
+    clock_start(ctx->clk);
+    for(;;){
+        //The port shifts in the oldest sample at the bottom of the word
+        uint32_t word = port_in(ctx->rx_port);
+        for(int i = 0; i < 32; i += width){
+            uart_rx_multi_sample(ctx, (word >> i) & sample_mask);
+        }
+    }
+}
+
+uart_buffer_error_t uart_rx_multi_read(uart_rx_multi_t *ctx, unsigned line, uint8_t *data){
+    xassert(line < UART_RX_MULTI_MAX_LINES);
+    return uart_ring_pop_byte(&ctx->line[line].buffer, data);
+}
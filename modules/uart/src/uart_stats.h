@@ -0,0 +1,72 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/**
+ * This file contains the statistics hooks used by the UART Tx and Rx. They
+ * compile out when UART_STATS_ENABLED is 0.
+ */
+
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <xcore/hwtimer.h>
+
+#include "uart.h"
+
+#if UART_STATS_ENABLED
+
+__attribute__((always_inline))
+inline void uart_stats_error(uart_stats_t *stats, uart_callback_code_t code){
+    switch(code){
+        case UART_START_BIT_ERROR:  stats->start_bit_errors += 1;   break;
+        case UART_PARITY_ERROR:     stats->parity_errors += 1;      break;
+        case UART_FRAMING_ERROR:    stats->framing_errors += 1;     break;
+        case UART_NOISE_ERROR:      stats->noise_errors += 1;       break;
+        case UART_OVERRUN_ERROR:    stats->overruns += 1;           break;
+        case UART_UNDERRUN_ERROR:   stats->underruns += 1;          break;
+        default:                                                    break;
+    }
+}
+
+__attribute__((always_inline))
+inline void uart_stats_isr_end(uart_stats_t *stats, uint32_t start_ticks){
+    uint32_t ticks = get_reference_time() - start_ticks;
+    if(stats->isr_count == 0 || ticks < stats->isr_ticks_min){
+        stats->isr_ticks_min = ticks;
+    }
+    if(ticks > stats->isr_ticks_max){
+        stats->isr_ticks_max = ticks;
+    }
+    stats->isr_ticks_total += ticks;
+    stats->isr_count += 1;
+}
+
+/* Copies the stats with the mean filled in. Called with interrupts masked */
+__attribute__((always_inline))
+inline void uart_stats_snapshot(const uart_stats_t *stats, uart_stats_t *snapshot){
+    *snapshot = *stats;
+    snapshot->isr_ticks_mean = stats->isr_count ? stats->isr_ticks_total / stats->isr_count : 0;
+}
+
+#define UART_STATS_INC(ctx, counter)        ((ctx)->stats.counter += 1)
+#define UART_STATS_ERROR(ctx, code)         uart_stats_error(&(ctx)->stats, (code))
+#define UART_STATS_HIGH_WATER(ctx, level)   do { \
+        uint32_t uart_stats_level_ = (level); \
+        if(uart_stats_level_ > (ctx)->stats.buffer_high_water){ (ctx)->stats.buffer_high_water = uart_stats_level_; } \
+    } while(0)
+#define UART_STATS_ISR_BEGIN(ctx)           const uint32_t uart_stats_isr_start_ = get_reference_time()
+#define UART_STATS_ISR_END(ctx)             uart_stats_isr_end(&(ctx)->stats, uart_stats_isr_start_)
+#define UART_STATS_RESET(ctx)               memset(&(ctx)->stats, 0, sizeof((ctx)->stats))
+#define UART_STATS_SNAPSHOT(ctx, snapshot)  uart_stats_snapshot(&(ctx)->stats, (snapshot))
+
+#else
+
+#define UART_STATS_INC(ctx, counter)
+#define UART_STATS_ERROR(ctx, code)
+#define UART_STATS_HIGH_WATER(ctx, level)
+#define UART_STATS_ISR_BEGIN(ctx)
+#define UART_STATS_ISR_END(ctx)
+#define UART_STATS_RESET(ctx)
+#define UART_STATS_SNAPSHOT(ctx, snapshot)  memset((snapshot), 0, sizeof(uart_stats_t))
+
+#endif
@@ -5,8 +5,14 @@
 #include <xcore/interrupt_wrappers.h>
 
 #include "uart.h"
+#include "uart_frame.h"
+#include "uart_tx_impl.h"
+#include "uart_stats.h"
 
 DECLARE_INTERRUPT_CALLBACK(uart_tx_handle_event, callback_info);
+DECLARE_INTERRUPT_CALLBACK(uart_tx_clocked_handle_event, callback_info);
+DECLARE_INTERRUPT_CALLBACK(uart_tx_cts_handle_event, callback_info);
+DECLARE_INTERRUPT_CALLBACK(uart_tx_kick_handle_event, callback_info);
 
 void uart_tx_blocking_init(
         uart_tx_t *uart_cfg,
@@ -21,10 +27,9 @@ void uart_tx_blocking_init(
                  NULL, 0, NULL, NULL);
 }
 
-void uart_tx_init(
+static void uart_tx_init_context(
         uart_tx_t *uart_cfg,
         port_t tx_port,
-        uint32_t baud_rate,
         uint8_t num_data_bits,
         uart_parity_t parity,
         uint8_t stop_bits,
@@ -37,9 +42,14 @@ void uart_tx_init(
         ){
 
     uart_cfg->tx_port = tx_port;
-    uart_cfg->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    uart_cfg->clk = 0;
+    uart_cfg->bit_time_frac = 0;
+    uart_cfg->bit_time_acc = 0;
 
     uart_cfg->next_event_time_ticks = 0;
+    uart_cfg->port_timed = 0;
+    uart_cfg->port_time_ticks = 0;
+    uart_cfg->port_time_valid = 0;
     xassert(num_data_bits <= 8);
     uart_cfg->num_data_bits = num_data_bits;
     xassert(parity == UART_PARITY_NONE || parity == UART_PARITY_EVEN || parity == UART_PARITY_ODD);
@@ -50,8 +60,8 @@ void uart_tx_init(
     uart_cfg->uart_data = 0;
     uart_cfg->state = UART_IDLE;
 
-    init_buffer(&uart_cfg->buffer, buffer, buffer_size_plus_one);
-    if(buffer_used(&uart_cfg->buffer)){
+    uart_ring_init(&uart_cfg->buffer, buffer, buffer_size_plus_one);
+    if(uart_ring_used(&uart_cfg->buffer)){
         xassert(buffer_size_plus_one > (1 + 1)); // Buffer must be at least one deep to be valid
         //From now on we just check to see if buffer is NULL or not for speed
     }
@@ -60,14 +70,56 @@ void uart_tx_init(
     uart_cfg->tmr = tmr;
 
     //Assert if buffer is used but no timer as we need the timer for buffered mode  
-    if(buffer_used(&uart_cfg->buffer) && !tmr){
+    if(uart_ring_used(&uart_cfg->buffer) && !tmr){
         xassert(0);    
     }
     //TODO work out if buffer can be used without HW timer
-    if(buffer_used(&uart_cfg->buffer)){
+    uart_cfg->uart_tx_empty_callback_fptr = uart_tx_empty_callback_fptr;
+    uart_cfg->uart_tx_low_watermark_callback_fptr = NULL;
+    uart_cfg->low_watermark = 0;
+    uart_cfg->cts_port = 0;
+    uart_cfg->de_port = 0;
+    uart_cfg->de_lead_ticks = 0;
+    uart_cfg->de_asserted = 0;
+    uart_cfg->de_time_offset = 0;
+    uart_cfg->space_chan.end_a = 0;
+    uart_cfg->space_chan.end_b = 0;
+    uart_cfg->space_waiter = 0;
+    uart_cfg->producer_lock = 0;
+    uart_cfg->claim_idx = 0;
+    uart_cfg->kick_chan.end_a = 0;
+    uart_cfg->kick_chan.end_b = 0;
+    uart_cfg->kick_pending = 0;
+    uart_cfg->crc.width = 0;
+    uart_cfg->specialised = 0;
+    UART_STATS_RESET(uart_cfg);
+    uart_cfg->app_data = app_data;
+}
+
+void uart_tx_init(
+        uart_tx_t *uart_cfg,
+        port_t tx_port,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        hwtimer_t tmr,
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_tx_empty_callback_fptr)(void* app_data),
+        void *app_data
+        ){
+
+    uart_tx_init_context(uart_cfg, tx_port, num_data_bits, parity, stop_bits, tmr,
+                         buffer, buffer_size_plus_one, uart_tx_empty_callback_fptr, app_data);
+    uart_cfg->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    uart_cfg->bit_time_frac = uart_bit_time_frac(baud_rate);
+    //Bits are timed on the 16b port timer unless they are too long to schedule a bit ahead
+    uart_cfg->port_timed = uart_cfg->bit_time_ticks < 0x8000;
+
+    if(uart_ring_used(&uart_cfg->buffer)){
         //Setup interrupt
-        uart_cfg->uart_tx_empty_callback_fptr = uart_tx_empty_callback_fptr;
-        uart_cfg->app_data = app_data;
         triggerable_setup_interrupt_callback(tmr, uart_cfg, INTERRUPT_CALLBACK(uart_tx_handle_event) );
         interrupt_unmask_all();
     }
@@ -76,158 +128,502 @@ void uart_tx_init(
     port_out(tx_port, 1); //Set to idle
 }
 
+// clock_set_divide() takes an 8b divide value. The port clock is ref_clk / (2 * divide)
+#define UART_TX_CLOCKED_MAX_DIVIDE  255
+
+void uart_tx_clocked_init(
+        uart_tx_t *uart_cfg,
+        port_t tx_port,
+        xclock_t clk,
+        uint32_t baud_rate,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        hwtimer_t tmr,
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_tx_empty_callback_fptr)(void* app_data),
+        void *app_data
+        ){
+
+    uart_tx_init_context(uart_cfg, tx_port, num_data_bits, parity, stop_bits, tmr,
+                         buffer, buffer_size_plus_one, uart_tx_empty_callback_fptr, app_data);
+
+    //Whole frame must fit into a single port transfer
+    xassert(1 + num_data_bits + (parity != UART_PARITY_NONE) + stop_bits <= 32);
+
+    uint32_t divide = (XS1_TIMER_HZ / 2 + baud_rate / 2) / baud_rate; //Round to nearest
+    xassert(divide >= 1 && divide <= UART_TX_CLOCKED_MAX_DIVIDE);
+    uart_cfg->clk = clk;
+    uart_cfg->bit_time_ticks = 2 * divide; //Exact since the port clock is derived from the ref clock
+    uart_cfg->bit_time_frac = 0;
+
+    clock_enable(clk);
+    clock_set_source_clk_ref(clk);
+    clock_set_divide(clk, divide);
+
+    port_start_buffered(tx_port, 32);
+    port_set_clock(tx_port, clk);
+    clock_start(clk);
+    uart_port_outpw(tx_port, 1, 1); //Set to idle
+    port_sync(tx_port);
+
+    if(uart_ring_used(&uart_cfg->buffer)){
+        //Setup interrupt
+        triggerable_setup_interrupt_callback(tmr, uart_cfg, INTERRUPT_CALLBACK(uart_tx_clocked_handle_event) );
+        interrupt_unmask_all();
+    }
+}
+
+
+void uart_tx_set_low_watermark(
+        uart_tx_t *uart_cfg,
+        uint32_t low_watermark,
+        void(*uart_tx_low_watermark_callback_fptr)(void* app_data)){
+
+    xassert(!uart_cfg->specialised); //Folded out of UART_TX_DEFINE()
+    xassert(low_watermark == 0 || uart_tx_low_watermark_callback_fptr != NULL);
+    xassert(low_watermark <= uart_ring_capacity(&uart_cfg->buffer));
+    interrupt_mask_all();
+    uart_cfg->uart_tx_low_watermark_callback_fptr = uart_tx_low_watermark_callback_fptr;
+    uart_cfg->low_watermark = low_watermark;
+    interrupt_unmask_all();
+}
+
+void uart_tx_set_multi_producer(
+        uart_tx_t *uart_cfg,
+        lock_t lock){
+
+    xassert(!uart_cfg->specialised); //Folded out of UART_TX_DEFINE()
+    xassert(uart_ring_used(&uart_cfg->buffer) && !uart_cfg->clk);
+    xassert(lock && !uart_cfg->producer_lock);
+    xassert(!uart_cfg->crc.width); //One running CRC cannot follow several producers
+    uart_cfg->kick_chan = s_chan_alloc();
+    xassert(uart_cfg->kick_chan.end_a);
+    interrupt_mask_all();
+    uart_cfg->claim_idx = uart_cfg->buffer.write_idx;
+    uart_cfg->kick_pending = 0;
+    uart_cfg->producer_lock = lock;
+    triggerable_setup_interrupt_callback(uart_cfg->kick_chan.end_b, uart_cfg, INTERRUPT_CALLBACK(uart_tx_kick_handle_event) );
+    triggerable_enable_trigger(uart_cfg->kick_chan.end_b);
+    interrupt_unmask_all();
+}
+
+uart_buffer_error_t uart_tx_write_message(uart_tx_t *uart_cfg, const uint8_t *data, size_t n){
+    xassert(uart_cfg->producer_lock);
+    uart_ring_t *ring = &uart_cfg->buffer;
+
+    //Claim. Space is only freed by the ISR so it cannot shrink once checked
+    lock_acquire(uart_cfg->producer_lock);
+    unsigned start = uart_cfg->claim_idx;
+    if(n > uart_ring_capacity(ring) - (start - ring->read_idx)){
+        lock_release(uart_cfg->producer_lock);
+        return UART_BUFFER_FULL;
+    }
+    uart_cfg->claim_idx = start + n;
+    lock_release(uart_cfg->producer_lock);
+
+    for(size_t i = 0; i < n; i++){
+        ring->buffer[(start + i) & ring->mask] = data[i];
+    }
+
+    //Commit in claim order so the ISR never sees a message with a gap before it
+    while(ring->write_idx != start);
+    ring->write_idx = start + n;
+    UART_STATS_HIGH_WATER(uart_cfg, uart_ring_fill_level(ring));
+
+    //Published before the state is read, and the ISR checks the fill level again
+    //after going idle, so one of us always starts the transmit
+    if(uart_cfg->state == UART_IDLE){
+        uart_tx_request_kick(uart_cfg);
+    }
+    return UART_BUFFER_OK;
+}
+
+void uart_tx_set_cts(
+        uart_tx_t *uart_cfg,
+        port_t cts_port){
+
+    xassert(!uart_cfg->specialised); //Folded out of UART_TX_DEFINE()
+    xassert(!uart_cfg->clk); //The whole frame is already in the port in clocked mode
+    port_enable(cts_port);
+    interrupt_mask_all();
+    uart_cfg->cts_port = cts_port;
+    if(uart_ring_used(&uart_cfg->buffer)){
+        triggerable_setup_interrupt_callback(cts_port, uart_cfg, INTERRUPT_CALLBACK(uart_tx_cts_handle_event) );
+        triggerable_disable_trigger(cts_port);
+    }
+    interrupt_unmask_all();
+}
+
+void uart_tx_set_rs485(
+        uart_tx_t *uart_cfg,
+        port_t de_port,
+        uint32_t lead_ticks){
+
+    xassert(!uart_cfg->specialised); //Folded out of UART_TX_DEFINE()
+    xassert(!uart_cfg->clk); //The DE port is timed from the state machine
+    //When port timed the lead is scheduled on the 16b port timer
+    xassert(!uart_cfg->port_timed || lead_ticks < 0x8000);
+    port_enable(de_port);
+    port_out(de_port, 0);
+    interrupt_mask_all();
+    uart_cfg->de_lead_ticks = lead_ticks;
+    uart_cfg->de_asserted = 0;
+    uart_cfg->de_port = de_port;
+    interrupt_unmask_all();
+}
+
+void uart_tx_get_stats(
+        uart_tx_t *uart_cfg,
+        uart_stats_t *stats){
+
+    interrupt_mask_all();
+    UART_STATS_SNAPSHOT(uart_cfg, stats);
+    interrupt_unmask_all();
+}
+
+void uart_tx_reset_stats(uart_tx_t *uart_cfg){
+    interrupt_mask_all();
+    UART_STATS_RESET(uart_cfg);
+    interrupt_unmask_all();
+}
 
 void uart_tx_deinit(uart_tx_t *uart_cfg){
-    if(buffer_used(&uart_cfg->buffer)){
+    if(uart_ring_used(&uart_cfg->buffer)){
         triggerable_disable_trigger(uart_cfg->tmr);
     }
+    if(uart_cfg->cts_port){
+        triggerable_disable_trigger(uart_cfg->cts_port);
+        port_disable(uart_cfg->cts_port);
+    }
+    if(uart_cfg->de_port){
+        port_sync(uart_cfg->de_port); //Let any timed release happen
+        port_disable(uart_cfg->de_port);
+    }
+    if(uart_cfg->producer_lock){
+        triggerable_disable_trigger(uart_cfg->kick_chan.end_b);
+        s_chan_free(uart_cfg->kick_chan);
+        uart_cfg->producer_lock = 0;
+    }
+    if(uart_cfg->space_chan.end_a){
+        s_chan_free(uart_cfg->space_chan);
+        uart_cfg->space_chan.end_a = 0;
+        uart_cfg->space_chan.end_b = 0;
+    }
+    if(uart_cfg->clk){
+        port_sync(uart_cfg->tx_port); //Let any frame in the port finish
+        clock_stop(uart_cfg->clk);
+        clock_disable(uart_cfg->clk);
+    }
     port_disable(uart_cfg->tx_port);
 }
 
+DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, uart_tx_handle_event, callback_info){
+    uart_tx_t *uart_cfg = (uart_tx_t*) callback_info;
+    UART_STATS_ISR_BEGIN(uart_cfg);
+    uart_tx_handle_event_impl(uart_cfg, uart_cfg->num_data_bits, uart_cfg->parity, uart_cfg->stop_bits, 1, UART_TX_FEATURES_ALL);
+    UART_STATS_ISR_END(uart_cfg);
+}
+
+
+/**
+ * Builds the whole frame, LSb first as the port shifts it out, and writes it
+ * to the buffered port. The port holds the last stop bit (idle) after the frame.
+ * Returns the frame duration in ticks.
+ */
 __attribute__((always_inline))
-static inline uint32_t get_current_time(uart_tx_t *uart_cfg){
-    if(uart_cfg->tmr){
-        return hwtimer_get_time(uart_cfg->tmr);
+static inline uint32_t uart_tx_clocked_send_frame(uart_tx_t *uart_cfg){
+    uint32_t frame = (uint32_t)uart_cfg->uart_data << 1; //Start bit is bit 0
+    uint32_t frame_bits = 1 + uart_cfg->num_data_bits;
+    if(uart_cfg->parity != UART_PARITY_NONE){
+        frame |= uart_parity_bit(uart_cfg->uart_data, uart_cfg->parity) << frame_bits;
+        frame_bits += 1;
     }
-    return get_reference_time();
+    frame |= ((1 << uart_cfg->stop_bits) - 1) << frame_bits;
+    frame_bits += uart_cfg->stop_bits;
+
+    uart_port_outpw(uart_cfg->tx_port, frame, frame_bits);
+    UART_STATS_INC(uart_cfg, frames);
+    return frame_bits * uart_cfg->bit_time_ticks;
 }
 
 __attribute__((always_inline))
-static inline void sleep_until_next_transition(uart_tx_t *uart_cfg){
-    if(buffer_used(&uart_cfg->buffer)){
-        //Setup next interrupt
+static inline uint32_t uart_tx_clocked_frame_ticks(uart_tx_t *uart_cfg){
+    uint32_t frame_bits = 1 + uart_cfg->num_data_bits + uart_cfg->stop_bits;
+    if(uart_cfg->parity != UART_PARITY_NONE){
+        frame_bits += 1;
+    }
+    return frame_bits * uart_cfg->bit_time_ticks;
+}
+
+// In clocked mode the timer fires half way through the frame in flight. By then it has
+// moved into the port shift register so the next frame can be queued without blocking.
+// UART_DATA - a frame is shifting out of the port
+// UART_STOP - the buffer was empty so we are waiting for the last frame to drain
+// UART_IDLE - nothing to send, the timer interrupt is disabled
+DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, uart_tx_clocked_handle_event, callback_info){
+    uart_tx_t *uart_cfg = (uart_tx_t*) callback_info;
+    UART_STATS_ISR_BEGIN(uart_cfg);
+    uart_buffer_error_t err = uart_ring_pop_byte(&uart_cfg->buffer, &uart_cfg->uart_data);
+    if(err == UART_BUFFER_OK){
+        uart_tx_check_low_watermark(uart_cfg, UART_TX_FEATURES_ALL);
+        uart_cfg->uart_data &= (1 << uart_cfg->num_data_bits) - 1; //uart_tx_write() queues unmasked data
+        if(uart_cfg->state == UART_DATA){
+            //Next frame starts as soon as this one finishes
+            uart_cfg->next_event_time_ticks += uart_tx_clocked_send_frame(uart_cfg);
+        } else {
+            //Port has drained so this frame starts now
+            uart_cfg->state = UART_DATA;
+            uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
+            uart_cfg->next_event_time_ticks += uart_tx_clocked_send_frame(uart_cfg) / 2;
+        }
         hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
-    } 
-    else if(uart_cfg->tmr){
-        //Wait on a the timer
-        hwtimer_wait_until(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
-    }else{
-        //Poll the timer
-        while(get_current_time(uart_cfg) < uart_cfg->next_event_time_ticks);
+    } else if(uart_cfg->state == UART_DATA){
+        //Final check once the frame in flight has gone, in case a write comes in meanwhile
+        uart_cfg->state = UART_STOP;
+        uart_cfg->next_event_time_ticks += uart_tx_clocked_frame_ticks(uart_cfg) / 2;
+        hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    } else {
+        uart_cfg->state = UART_IDLE;
+        triggerable_disable_trigger(uart_cfg->tmr);
+        (*uart_cfg->uart_tx_empty_callback_fptr)(uart_cfg->app_data);
     }
+    UART_STATS_ISR_END(uart_cfg);
 }
 
-__attribute__((always_inline))
-static inline void buffered_uart_tx_char_finished(uart_tx_t *uart_cfg){
-    uart_buffer_error_t err = pop_byte_from_buffer(&uart_cfg->buffer, &uart_cfg->uart_data);
+/**
+ * Starts the buffered transmit of a frame from idle. The interrupt is not
+ * running so the ISR state may be modified freely.
+ */
+DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, uart_tx_cts_handle_event, callback_info){
+    uart_tx_t *uart_cfg = (uart_tx_t*) callback_info;
+    UART_STATS_ISR_BEGIN(uart_cfg);
+    port_in(uart_cfg->cts_port); //CTS asserted. Clears the event
+    triggerable_disable_trigger(uart_cfg->cts_port);
+    uart_buffer_error_t err = uart_ring_pop_byte(&uart_cfg->buffer, &uart_cfg->uart_data);
     if(err == UART_BUFFER_OK){
+        uart_tx_check_low_watermark(uart_cfg, UART_TX_FEATURES_ALL);
+        uart_cfg->uart_data &= (1 << uart_cfg->num_data_bits) - 1;
         uart_cfg->state = UART_START;
+        uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
         hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+        triggerable_enable_trigger(uart_cfg->tmr);
     } else {
         uart_cfg->state = UART_IDLE;
+        (*uart_cfg->uart_tx_empty_callback_fptr)(uart_cfg->app_data);
+        uart_tx_check_missed_kick(uart_cfg, UART_TX_FEATURES_ALL);
     }
+    UART_STATS_ISR_END(uart_cfg);
 }
 
-// There was additional latency introduced in the start bit causing a slight stretching.
-// This is due to UART_START get current_time not including the ISR or fn call
-// It has been measured on the simulator to be 170-174ns for polling/event and 230-260ns for ISR 
-#define INTERRUPT_LATENCY_COMPENSATION_TICKS (XS1_TIMER_MHZ * 245 / 1000)
-#define BLOCKING_LATENCY_COMPENSATION_TICKS  (XS1_TIMER_MHZ * 170 / 1000)
+/**
+ * Starts the buffered transmit from idle when asked by a multi-producer write.
+ * Unlike uart_tx_kick() the byte is never pushed back, as only producers may
+ * write to the buffer.
+ */
+DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, uart_tx_kick_handle_event, callback_info){
+    uart_tx_t *uart_cfg = (uart_tx_t*) callback_info;
+    UART_STATS_ISR_BEGIN(uart_cfg);
+    s_chan_check_ct_end(uart_cfg->kick_chan.end_b);
+    uart_cfg->kick_pending = 0; //Cleared first so a later commit asks again
+    if(uart_cfg->state == UART_IDLE && uart_ring_fill_level(&uart_cfg->buffer)){
+        uart_tx_isr_restart(uart_cfg, UART_TX_FEATURES_ALL);
+    }
+    UART_STATS_ISR_END(uart_cfg);
+}
 
+__attribute__((always_inline))
+static inline void uart_tx_kick(uart_tx_t *uart_cfg, uint8_t data){
+    uart_cfg->uart_data = data & ((1 << uart_cfg->num_data_bits) - 1);
+    if(uart_tx_cts_blocked(uart_cfg, UART_TX_FEATURES_ALL)){
+        //Only called with the buffer empty so this keeps the order
+        uart_ring_push_byte(&uart_cfg->buffer, data);
+        UART_STATS_HIGH_WATER(uart_cfg, 1);
+        uart_tx_cts_pause(uart_cfg);
+        return;
+    }
+    if(uart_cfg->clk){
+        uart_cfg->state = UART_DATA;
+        uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
+        uart_cfg->next_event_time_ticks += uart_tx_clocked_send_frame(uart_cfg) / 2;
+        hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    } else {
+        uart_cfg->state = UART_START;
+        uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
+        uart_tx_sleep_until_next_transition(uart_cfg);//Set event for now
+    }
+    triggerable_enable_trigger(uart_cfg->tmr);
+}
 
-DEFINE_INTERRUPT_CALLBACK(UART_TX_INTERRUPTABLE_FUNCTIONS, uart_tx_handle_event, callback_info){
-    uart_tx_t *uart_cfg = (uart_tx_t*) callback_info;
-    switch(uart_cfg->state){
-        case UART_START: {
-            uart_cfg->next_event_time_ticks = get_current_time(uart_cfg);
-            port_out(uart_cfg->tx_port, 0);
-            uart_cfg->state = UART_DATA;
-            uart_cfg->current_data_bit = 0;
-            uart_cfg->next_event_time_ticks += uart_cfg->bit_time_ticks;
-            if(buffer_used(&uart_cfg->buffer)){
-                uart_cfg->next_event_time_ticks -= INTERRUPT_LATENCY_COMPENSATION_TICKS;
-            } else {
-                uart_cfg->next_event_time_ticks -= BLOCKING_LATENCY_COMPENSATION_TICKS;
+void uart_tx(uart_tx_t *uart_cfg, uint8_t data){
+    xassert(!uart_cfg->producer_lock); //Use uart_tx_write_message()
+    uint32_t mask = 0;
+    asm volatile("mkmsk %0, %1": "=r"(mask) : "r"(uart_cfg->num_data_bits));
+    data &= mask;//So pariy gets calc'd properly
+    //Check to see if we are using interrupts/buffered mode
+    if(uart_ring_used(&uart_cfg->buffer)){
+        if(uart_ring_fill_level(&uart_cfg->buffer) == 0 && uart_cfg->state == UART_IDLE){//Kick off a transmit
+            uart_tx_kick(uart_cfg, data);
+        } else {//Transaction already underway
+            if(uart_ring_push_byte(&uart_cfg->buffer, data) == UART_BUFFER_FULL){
+                UART_STATS_ERROR(uart_cfg, UART_OVERRUN_ERROR);
+                return; //Dropped, so it is not sent or in the CRC
             }
-            break;
+            UART_STATS_HIGH_WATER(uart_cfg, uart_ring_fill_level(&uart_cfg->buffer));
         }
+    } else if(uart_cfg->clk){
+        uart_cfg->uart_data = data;
+        uart_tx_clocked_send_frame(uart_cfg);
+        port_sync(uart_cfg->tx_port); //Blocking call returns at the end of the stop bit
+    } else {
+        //Blocking call
+        uart_tx_blocking_impl(uart_cfg, data, uart_cfg->num_data_bits, uart_cfg->parity, uart_cfg->stop_bits, UART_TX_FEATURES_ALL);
+    }
+    if(uart_cfg->crc.width){
+        uart_crc_update(&uart_cfg->crc, data); //Only once it is queued or sent
+    }
+}
 
-        case UART_DATA: {    
-            uint32_t port_val = (uart_cfg->uart_data >> uart_cfg->current_data_bit) & 0x1;
-            port_out(uart_cfg->tx_port, port_val);
-            uart_cfg->current_data_bit++;
-            uart_cfg->next_event_time_ticks += uart_cfg->bit_time_ticks;
-            if(uart_cfg->current_data_bit == uart_cfg->num_data_bits){
-                if(uart_cfg->parity == UART_PARITY_NONE){
-                    uart_cfg->state = UART_STOP;
-                } else {
-                    uart_cfg->state = UART_PARITY;
-                }
-            }
-            break;
-        }
+/**
+ * Queues a word in buffered mode, starting the transmit if idle. Called with
+ * interrupts masked so the ISR cannot go idle between the check and the push.
+ */
+static uart_buffer_error_t uart_tx_queue(uart_tx_t *uart_cfg, uint8_t data){
+    xassert(!uart_cfg->producer_lock); //Use uart_tx_write_message()
+    data &= (1 << uart_cfg->num_data_bits) - 1;
+    uart_buffer_error_t err = UART_BUFFER_OK;
+    if(uart_ring_fill_level(&uart_cfg->buffer) == 0 && uart_cfg->state == UART_IDLE){
+        uart_tx_kick(uart_cfg, data);
+    } else {
+        err = uart_ring_push_byte(&uart_cfg->buffer, data);
+        UART_STATS_HIGH_WATER(uart_cfg, uart_ring_fill_level(&uart_cfg->buffer));
+    }
+    if(err == UART_BUFFER_OK && uart_cfg->crc.width){
+        uart_crc_update(&uart_cfg->crc, data); //Only once it is queued, as uart_tx_wait() retries
+    }
+    return err;
+}
+
+uart_buffer_error_t uart_tx_try(uart_tx_t *uart_cfg, uint8_t data){
+    xassert(uart_ring_used(&uart_cfg->buffer));
+    interrupt_mask_all();
+    uart_buffer_error_t err = uart_tx_queue(uart_cfg, data);
+    interrupt_unmask_all();
+    return err;
+}
 
-        case UART_PARITY: {
-            uint32_t parity_setting = (uart_cfg->parity == UART_PARITY_EVEN) ? 0 : 1;
-            uint32_t parity = (unsigned)uart_cfg->uart_data;
-            // crc32(parity, parity_setting, 1); //http://bugzilla/show_bug.cgi?id=18663
-            asm volatile("crc32 %0, %2, %3" : "=r" (parity) : "0" (parity), "r" (parity_setting), "r" (1));
-            port_out(uart_cfg->tx_port, parity);
-            uart_cfg->state = UART_STOP;
-            uart_cfg->next_event_time_ticks += uart_cfg->bit_time_ticks;
-            break;
+void uart_tx_wait(uart_tx_t *uart_cfg, uint8_t data){
+    xassert(!uart_cfg->specialised); //Folded out of UART_TX_DEFINE()
+    xassert(uart_ring_used(&uart_cfg->buffer));
+    if(!uart_cfg->space_chan.end_a){
+        uart_cfg->space_chan = s_chan_alloc();
+        xassert(uart_cfg->space_chan.end_a);
+    }
+    for(;;){
+        interrupt_mask_all();
+        if(uart_tx_queue(uart_cfg, data) == UART_BUFFER_OK){
+            interrupt_unmask_all();
+            return;
         }
-     
-        case UART_STOP: {   
-            port_out(uart_cfg->tx_port, 1);
-            uart_cfg->current_stop_bit += 1;
-            uart_cfg->next_event_time_ticks += uart_cfg->bit_time_ticks; //do before buffered_uart_tx_char_finished
-
-            if(uart_cfg->current_stop_bit == uart_cfg->stop_bits){
-                uart_cfg->current_stop_bit = 0;
-                if(buffer_used(&uart_cfg->buffer)){
-                    buffered_uart_tx_char_finished(uart_cfg);//Next state is set here
-                } else {
-                    uart_cfg->state = UART_IDLE;
-                }
+        //Set while masked so the next word the ISR takes signals us. If that
+        //happens before we get to the input the token waits in the channel end.
+        uart_cfg->space_waiter = 1;
+        interrupt_unmask_all();
+        s_chan_check_ct_end(uart_cfg->space_chan.end_b);
+    }
+}
+
+/**
+ * Starts the buffered transmit of newly queued data if the ISR has gone idle
+ */
+static void uart_tx_start_if_idle(uart_tx_t *uart_cfg){
+    //The ISR may still be holding the last stop bit when idle so keep it out while we decide
+    interrupt_mask_all();
+    if(uart_cfg->state == UART_IDLE){
+        if(uart_tx_cts_blocked(uart_cfg, UART_TX_FEATURES_ALL)){
+            uart_tx_cts_pause(uart_cfg);
+        } else {
+            //Take the first byte back out and start once for the whole block
+            uint8_t first = 0;
+            if(uart_ring_pop_byte(&uart_cfg->buffer, &first) == UART_BUFFER_OK){
+                uart_tx_kick(uart_cfg, first);
             }
-            break;
         }
+    }
+    interrupt_unmask_all();
+}
 
-        case UART_IDLE: {
-            //This state is only entered in buffered mode at end stream and holds the stop bit
-            //Final check for new data to see if we need to start again or not in case write came in during stop bit
-            buffered_uart_tx_char_finished(uart_cfg);
-            if(uart_cfg->state == UART_IDLE){
-                triggerable_disable_trigger(uart_cfg->tmr);
-                (*uart_cfg->uart_tx_empty_callback_fptr)(uart_cfg->app_data);
-            }
-            break;
+size_t uart_tx_write(uart_tx_t *uart_cfg, const uint8_t *data, size_t n){
+    if(!uart_ring_used(&uart_cfg->buffer)){
+        for(size_t i = 0; i < n; i++){
+            uart_tx(uart_cfg, data[i]);
         }
+        return n;
+    }
 
-        default: {
-            xassert(0);
+    xassert(!uart_cfg->producer_lock); //Use uart_tx_write_message()
+    size_t queued = uart_ring_push(&uart_cfg->buffer, data, n);
+    if(uart_cfg->crc.width){
+        //The data was just read for the copy so this second read is from cache
+        uint8_t mask = (1 << uart_cfg->num_data_bits) - 1; //Only the bits on the wire, as in uart_tx()
+        for(size_t i = 0; i < queued; i++){
+            uart_crc_update(&uart_cfg->crc, data[i] & mask);
         }
     }
-    if(buffer_used(&uart_cfg->buffer)){
-        sleep_until_next_transition(uart_cfg);
+    UART_STATS_HIGH_WATER(uart_cfg, uart_ring_fill_level(&uart_cfg->buffer));
+    if(queued){
+        uart_tx_start_if_idle(uart_cfg);
     }
+    return queued;
 }
 
+uint8_t *uart_tx_reserve(uart_tx_t *uart_cfg, size_t n, size_t *len){
+    xassert(uart_ring_used(&uart_cfg->buffer));
+    xassert(!uart_cfg->producer_lock); //Use uart_tx_write_message()
+    return uart_ring_reserve(&uart_cfg->buffer, n, len);
+}
 
-
-void uart_tx(uart_tx_t *uart_cfg, uint8_t data){
-    uint32_t mask = 0;
-    asm volatile("mkmsk %0, %1": "=r"(mask) : "r"(uart_cfg->num_data_bits));
-    data &= mask;//So pariy gets calc'd properly
-    //Check to see if we are using interrupts/buffered mode
-    if(buffer_used(&uart_cfg->buffer)){
-        if(get_buffer_fill_level(&uart_cfg->buffer) == 0 && uart_cfg->state == UART_IDLE){//Kick off a transmit
-            uart_cfg->uart_data = data;
-            uart_cfg->state = UART_START;
-            uart_cfg->next_event_time_ticks = get_current_time(uart_cfg); 
-            sleep_until_next_transition(uart_cfg);//Set event for now
-            triggerable_enable_trigger(uart_cfg->tmr);
-        } else {//Transaction already underway
-            push_byte_into_buffer(&uart_cfg->buffer, data);
+void uart_tx_commit(uart_tx_t *uart_cfg, size_t n){
+    if(uart_cfg->crc.width){
+        //The words are in the ring and not yet visible to the ISR
+        uart_ring_t *ring = &uart_cfg->buffer;
+        uint8_t mask = (1 << uart_cfg->num_data_bits) - 1;
+        for(size_t i = 0; i < n; i++){
+            uart_crc_update(&uart_cfg->crc, ring->buffer[(ring->write_idx + i) & ring->mask] & mask);
         }
+    }
+    uart_ring_commit(&uart_cfg->buffer, n);
+    UART_STATS_HIGH_WATER(uart_cfg, uart_ring_fill_level(&uart_cfg->buffer));
+    if(n){
+        uart_tx_start_if_idle(uart_cfg);
+    }
+}
+
+void uart_tx_set_crc(
+        uart_tx_t *uart_cfg,
+        const uart_crc_t *crc){
+
+    xassert(!uart_cfg->producer_lock);
+    if(crc != NULL){
+        uart_cfg->crc = *crc;
+        uart_crc_reset(&uart_cfg->crc);
     } else {
-        uart_cfg->uart_data = data;
-        uart_cfg->state = UART_START;
-        //Blocking call
-        do {
-            uart_tx_handle_event(uart_cfg);
-            sleep_until_next_transition(uart_cfg);
-        } while(uart_cfg->state != UART_IDLE);
+        uart_cfg->crc.width = 0;
+    }
+}
+
+void uart_tx_send_crc(uart_tx_t *uart_cfg){
+    xassert(uart_cfg->crc.width);
+    uint8_t bytes[4];
+    size_t n = uart_crc_get_bytes(&uart_cfg->crc, bytes);
+    for(size_t i = 0; i < n; i++){
+        if(uart_ring_used(&uart_cfg->buffer)){
+            uart_tx_wait(uart_cfg, bytes[i]);
+        } else {
+            uart_tx(uart_cfg, bytes[i]);
+        }
     }
+    uart_crc_reset(&uart_cfg->crc); //Sending the CRC updated it too
 }
@@ -0,0 +1,366 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+/**
+ * This file contains the timer driven UART Tx state machine. It is inlined into
+ * the generic ISR in uart_tx.c and into the specialised ones from UART_TX_DEFINE().
+ */
+
+#pragma once
+#include <stdint.h>
+#include <xcore/assert.h>
+#include <xcore/port.h>
+#include <xcore/hwtimer.h>
+#include <xcore/triggerable.h>
+#include <xcore/channel_streaming.h>
+#include <xcore/lock.h>
+
+#include "uart.h"
+#include "uart_frame.h"
+#include "uart_stats.h"
+
+/**
+ * The runtime features the state machine checks for. The generic ISR and calls
+ * pass UART_TX_FEATURES_ALL, and UART_TX_DEFINE() passes none so the checks fold
+ * away. A specialised UART Tx asserts if any of these are enabled on it.
+ */
+#define UART_TX_FEATURE_DE              (1 << 0)
+#define UART_TX_FEATURE_CTS             (1 << 1)
+#define UART_TX_FEATURE_WATERMARK       (1 << 2)
+#define UART_TX_FEATURE_WAIT            (1 << 3)
+#define UART_TX_FEATURE_MULTI_PRODUCER  (1 << 4)
+#define UART_TX_FEATURES_ALL            0xffffffff
+
+__attribute__((always_inline))
+static inline uint32_t uart_tx_get_current_time(uart_tx_t *uart_cfg){
+    if(uart_cfg->tmr){
+        return hwtimer_get_time(uart_cfg->tmr);
+    }
+    return get_reference_time();
+}
+
+__attribute__((always_inline))
+static inline void uart_tx_sleep_until_next_transition(uart_tx_t *uart_cfg){
+    if(uart_ring_used(&uart_cfg->buffer)){
+        //Setup next interrupt
+        hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    } 
+    else if(uart_cfg->tmr){
+        //Wait on a the timer
+        hwtimer_wait_until(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    }else{
+        //Poll the timer
+        while(uart_tx_get_current_time(uart_cfg) < uart_cfg->next_event_time_ticks);
+    }
+}
+
+/**
+ * Called by the ISR after each successful pop. The fill level only falls by
+ * popping, so it passes through one below the watermark exactly once per drain.
+ * There is now space in the buffer so any uart_tx_wait() is woken too.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_check_low_watermark(uart_tx_t *uart_cfg, const uint32_t features){
+    if((features & UART_TX_FEATURE_WATERMARK) && uart_cfg->low_watermark &&
+       uart_ring_fill_level(&uart_cfg->buffer) == uart_cfg->low_watermark - 1){
+        (*uart_cfg->uart_tx_low_watermark_callback_fptr)(uart_cfg->app_data);
+    }
+    if((features & UART_TX_FEATURE_WAIT) && uart_cfg->space_waiter){
+        uart_cfg->space_waiter = 0;
+        s_chan_out_ct_end(uart_cfg->space_chan.end_a); //Buffered by the channel end so never blocks
+    }
+}
+
+/**
+ * Asks the ISR to start sending from idle, unless it has already been asked.
+ * Used for multi-producer writes, which may not be on the ISR thread.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_request_kick(uart_tx_t *uart_cfg){
+    lock_acquire(uart_cfg->producer_lock);
+    uint32_t send = !uart_cfg->kick_pending;
+    uart_cfg->kick_pending = 1;
+    lock_release(uart_cfg->producer_lock);
+    if(send){
+        s_chan_out_ct_end(uart_cfg->kick_chan.end_a); //Only one sender until the ISR takes it
+    }
+}
+
+/**
+ * Returns non-zero if CTS flow control is enabled and the far end has deasserted CTS
+ */
+__attribute__((always_inline))
+static inline int uart_tx_cts_blocked(uart_tx_t *uart_cfg, const uint32_t features){
+    return (features & UART_TX_FEATURE_CTS) && uart_cfg->cts_port && (port_in(uart_cfg->cts_port) & 0x1);
+}
+
+/**
+ * Stops the buffered Tx at a frame boundary with data still queued. The CTS
+ * port event restarts it once CTS is asserted again.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_cts_pause(uart_tx_t *uart_cfg){
+    uart_cfg->state = UART_PAUSED;
+    uart_cfg->port_time_valid = 0;
+    triggerable_disable_trigger(uart_cfg->tmr);
+    port_set_trigger_in_equal(uart_cfg->cts_port, 0);
+    triggerable_enable_trigger(uart_cfg->cts_port);
+}
+
+/**
+ * Starts the buffered transmit from idle in the ISR, with a new start bit
+ * timed from now. Only called with data in the buffer.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_isr_restart(uart_tx_t *uart_cfg, const uint32_t features){
+    if(uart_tx_cts_blocked(uart_cfg, features)){
+        uart_tx_cts_pause(uart_cfg);
+        return;
+    }
+    uart_ring_pop_byte(&uart_cfg->buffer, &uart_cfg->uart_data);
+    uart_tx_check_low_watermark(uart_cfg, features);
+    uart_cfg->uart_data &= (1 << uart_cfg->num_data_bits) - 1;
+    uart_cfg->state = UART_START;
+    uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
+    hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    triggerable_enable_trigger(uart_cfg->tmr);
+}
+
+/**
+ * Called by the ISR once it has gone idle. A multi-producer write committed
+ * after the last pop may have seen the state just before it went idle, and so
+ * not asked for a kick. The lock is not taken here as a producer on this
+ * thread may hold it.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_check_missed_kick(uart_tx_t *uart_cfg, const uint32_t features){
+    if((features & UART_TX_FEATURE_MULTI_PRODUCER) && uart_cfg->producer_lock && uart_ring_fill_level(&uart_cfg->buffer)){
+        uart_tx_isr_restart(uart_cfg, features);
+    }
+}
+
+__attribute__((always_inline))
+static inline void uart_tx_buffered_char_finished(uart_tx_t *uart_cfg, const uint32_t features){
+    if(uart_ring_fill_level(&uart_cfg->buffer) && uart_tx_cts_blocked(uart_cfg, features)){
+        uart_tx_cts_pause(uart_cfg);
+        return;
+    }
+    uart_buffer_error_t err = uart_ring_pop_byte(&uart_cfg->buffer, &uart_cfg->uart_data);
+    if(err == UART_BUFFER_OK){
+        uart_tx_check_low_watermark(uart_cfg, features);
+        uart_cfg->uart_data &= (1 << uart_cfg->num_data_bits) - 1; //uart_tx_write() queues unmasked data
+        uart_cfg->state = UART_START;
+        hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    } else {
+        uart_cfg->state = UART_IDLE;
+    }
+}
+
+// There was additional latency introduced in the start bit causing a slight stretching.
+// This is due to UART_START get current_time not including the ISR or fn call
+// It has been measured on the simulator to be 170-174ns for polling/event and 230-260ns for ISR 
+#define UART_TX_INTERRUPT_LATENCY_COMPENSATION_TICKS (XS1_TIMER_MHZ * 245 / 1000)
+#define UART_TX_BLOCKING_LATENCY_COMPENSATION_TICKS  (XS1_TIMER_MHZ * 170 / 1000)
+
+// When port timed the first start bit after idle is sent at least this far after the port
+// time is read, so the timed output is never scheduled for a time that has already passed
+#define UART_TX_PORT_TIMED_MIN_LEAD_TICKS            (XS1_TIMER_MHZ * 1)
+
+/**
+ * Sends the next bit. When port timed the bit goes out exactly one bit time
+ * after the last one however late the ISR runs, as long as it is within a bit.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_send_bit(uart_tx_t *uart_cfg, uint32_t bit){
+    uint32_t ticks = uart_next_bit_ticks(&uart_cfg->bit_time_acc, uart_cfg->bit_time_ticks, uart_cfg->bit_time_frac);
+    uart_cfg->next_event_time_ticks += ticks;
+    if(uart_cfg->port_timed){
+        uart_cfg->port_time_ticks += ticks;
+        port_out_at_time(uart_cfg->tx_port, uart_cfg->port_time_ticks & 0xffff, bit);
+    } else {
+        port_out(uart_cfg->tx_port, bit);
+    }
+}
+
+
+/**
+ * Drives DE high and notes how the DE port timer relates to the reference
+ * timer, so the release can be timed on the port.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_de_assert(uart_tx_t *uart_cfg){
+    port_out(uart_cfg->de_port, 1);
+    uint32_t now = uart_tx_get_current_time(uart_cfg);
+    uart_cfg->de_time_offset = now - port_get_trigger_time(uart_cfg->de_port);
+    uart_cfg->de_asserted = 1;
+}
+
+/**
+ * Drives DE low at the end of the last stop bit. Called once the stop bit is on
+ * the line, so when port timed the release is at most a bit time ahead whatever
+ * the baud rate, and otherwise the stop bit has already ended.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_de_release(uart_tx_t *uart_cfg){
+    if(uart_cfg->port_timed){
+        uint32_t release_time = uart_cfg->next_event_time_ticks + uart_cfg->bit_time_ticks - uart_cfg->de_time_offset;
+        port_out_at_time(uart_cfg->de_port, release_time & 0xffff, 0);
+    } else {
+        port_out(uart_cfg->de_port, 0);
+    }
+    uart_cfg->de_asserted = 0;
+}
+
+/**
+ * Runs one step of the Tx state machine. The frame format, mode and runtime
+ * features are passed in so that when they are constants the parity, stop bit,
+ * buffer and feature checks fold away. See UART_TX_DEFINE().
+ */
+__attribute__((always_inline))
+static inline void uart_tx_handle_event_impl(
+        uart_tx_t *uart_cfg,
+        const uint32_t num_data_bits,
+        const uart_parity_t parity,
+        const uint32_t stop_bits,
+        const int buffered,
+        const uint32_t features){
+
+    switch(uart_cfg->state){
+        case UART_START: {
+            uint32_t lead_ticks = uart_cfg->bit_time_ticks;
+            if((features & UART_TX_FEATURE_DE) && uart_cfg->de_port && !uart_cfg->de_asserted){
+                //Turn the RS-485 driver on and send the start bit after the lead time
+                uart_tx_de_assert(uart_cfg);
+                if(!uart_cfg->port_timed){
+                    uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg) + uart_cfg->de_lead_ticks;
+                    break;
+                }
+                uart_cfg->port_time_valid = 0;
+                lead_ticks = uart_cfg->de_lead_ticks;
+            }
+            uart_cfg->state = UART_DATA;
+            uart_cfg->current_data_bit = 0;
+            UART_STATS_INC(uart_cfg, frames);
+            if(uart_cfg->port_timed){
+                if(uart_cfg->port_time_valid){
+                    //Back to back frame so the start bit follows the last stop bit exactly
+                    uart_tx_send_bit(uart_cfg, 0);
+                    break;
+                }
+                //Read the port time with an idle output and send the start bit a bit later
+                if(lead_ticks < UART_TX_PORT_TIMED_MIN_LEAD_TICKS){
+                    lead_ticks = UART_TX_PORT_TIMED_MIN_LEAD_TICKS;
+                }
+                port_out(uart_cfg->tx_port, 1);
+                uart_cfg->port_time_ticks = port_get_trigger_time(uart_cfg->tx_port) + lead_ticks;
+                uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg) + lead_ticks;
+                uart_cfg->port_time_valid = 1;
+                uart_cfg->bit_time_acc = 0;
+                port_out_at_time(uart_cfg->tx_port, uart_cfg->port_time_ticks & 0xffff, 0);
+                break;
+            }
+            uart_cfg->next_event_time_ticks = uart_tx_get_current_time(uart_cfg);
+            port_out(uart_cfg->tx_port, 0);
+            uart_cfg->bit_time_acc = 0;
+            uart_cfg->next_event_time_ticks += uart_next_bit_ticks(&uart_cfg->bit_time_acc, uart_cfg->bit_time_ticks, uart_cfg->bit_time_frac);
+            if(buffered){
+                uart_cfg->next_event_time_ticks -= UART_TX_INTERRUPT_LATENCY_COMPENSATION_TICKS;
+            } else {
+                uart_cfg->next_event_time_ticks -= UART_TX_BLOCKING_LATENCY_COMPENSATION_TICKS;
+            }
+            break;
+        }
+
+        case UART_DATA: {    
+            uint32_t port_val = (uart_cfg->uart_data >> uart_cfg->current_data_bit) & 0x1;
+            uart_tx_send_bit(uart_cfg, port_val);
+            uart_cfg->current_data_bit++;
+            if(uart_cfg->current_data_bit == num_data_bits){
+                if(parity == UART_PARITY_NONE){
+                    uart_cfg->state = UART_STOP;
+                } else {
+                    uart_cfg->state = UART_PARITY;
+                }
+            }
+            break;
+        }
+
+        case UART_PARITY: {
+            uart_tx_send_bit(uart_cfg, uart_parity_bit(uart_cfg->uart_data, parity));
+            uart_cfg->state = UART_STOP;
+            break;
+        }
+     
+        case UART_STOP: {   
+            uart_tx_send_bit(uart_cfg, 1); //do before buffered_uart_tx_char_finished
+            uart_cfg->current_stop_bit += 1;
+
+            if(uart_cfg->current_stop_bit == stop_bits){
+                uart_cfg->current_stop_bit = 0;
+                if(buffered){
+                    uart_tx_buffered_char_finished(uart_cfg, features);//Next state is set here
+                } else {
+                    uart_cfg->state = UART_IDLE;
+                    uart_cfg->port_time_valid = 0;
+                }
+            }
+            break;
+        }
+
+        case UART_IDLE: {
+            //This state is only entered in buffered mode at end stream and holds the stop bit
+            //Final check for new data to see if we need to start again or not in case write came in during stop bit
+            uart_tx_buffered_char_finished(uart_cfg, features);
+            if(uart_cfg->state == UART_IDLE){
+                if((features & UART_TX_FEATURE_DE) && uart_cfg->de_port){
+                    uart_tx_de_release(uart_cfg);
+                }
+                uart_cfg->port_time_valid = 0;
+                triggerable_disable_trigger(uart_cfg->tmr);
+                (*uart_cfg->uart_tx_empty_callback_fptr)(uart_cfg->app_data);
+                uart_tx_check_missed_kick(uart_cfg, features);
+            }
+            break;
+        }
+
+        default: {
+            xassert(0);
+        }
+    }
+    if(buffered){
+        hwtimer_set_trigger_time(uart_cfg->tmr, uart_cfg->next_event_time_ticks);
+    }
+}
+
+/**
+ * Sends one frame from the calling thread, returning at the end of the last stop
+ * bit. The data must already be masked to the frame width.
+ */
+__attribute__((always_inline))
+static inline void uart_tx_blocking_impl(
+        uart_tx_t *uart_cfg,
+        uint8_t data,
+        const uint32_t num_data_bits,
+        const uart_parity_t parity,
+        const uint32_t stop_bits,
+        const uint32_t features){
+
+    if((features & UART_TX_FEATURE_CTS) && uart_cfg->cts_port){
+        port_in_when_pinseq(uart_cfg->cts_port, PORT_UNBUFFERED, 0); //Wait for CTS
+    }
+    uart_cfg->uart_data = data;
+    uart_cfg->state = UART_START;
+    do {
+        uart_tx_handle_event_impl(uart_cfg, num_data_bits, parity, stop_bits, 0, features);
+        uart_tx_sleep_until_next_transition(uart_cfg);
+    } while(uart_cfg->state != UART_IDLE);
+    if((features & UART_TX_FEATURE_DE) && uart_cfg->de_port){
+        uart_tx_de_release(uart_cfg);
+    }
+    if(uart_cfg->port_timed){
+        //The loop ends as the last stop bit starts, so wait for it to complete like the timer driven path
+        port_sync(uart_cfg->tx_port);
+        uart_cfg->next_event_time_ticks += uart_cfg->bit_time_ticks;
+        uart_tx_sleep_until_next_transition(uart_cfg);
+    }
+}
@@ -0,0 +1,131 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <stdint.h>
+#include <xclib.h>
+#include <xcore/assert.h>
+
+#include "uart.h"
+#include "uart_frame.h"
+
+void uart_tx_multi_init(
+        uart_tx_multi_t *ctx,
+        port_t tx_port,
+        uint32_t port_width,
+        uint32_t baud_rate){
+
+    xassert(port_width == 4 || port_width == 8);
+    ctx->tx_port = tx_port;
+    ctx->port_width = port_width;
+    ctx->bit_time_ticks = XS1_TIMER_HZ / baud_rate;
+    ctx->bit_time_frac = uart_bit_time_frac(baud_rate);
+    xassert(ctx->bit_time_ticks < 0x10000); //The port timer is 16b
+    ctx->line_mask = 0;
+
+    port_enable(tx_port);
+    port_out(tx_port, (1 << port_width) - 1); //Set all lines to idle
+}
+
+void uart_tx_multi_line_init(
+        uart_tx_multi_t *ctx,
+        unsigned line,
+        uint8_t num_data_bits,
+        uart_parity_t parity,
+        uint8_t stop_bits,
+
+        uint8_t *buffer,
+        size_t buffer_size_plus_one,
+        void(*uart_tx_empty_callback_fptr)(void* app_data),
+        void *app_data
+        ){
+
+    xassert(line < ctx->port_width);
+    xassert(num_data_bits <= 8 && num_data_bits >= 5);
+    xassert(parity == UART_PARITY_NONE || parity == UART_PARITY_EVEN || parity == UART_PARITY_ODD);
+    xassert(stop_bits == 1 || stop_bits == 2);
+    xassert(buffer != NULL);
+
+    uart_tx_multi_line_t *l = &ctx->line[line];
+    l->state = UART_IDLE;
+    l->parity = parity;
+    l->num_data_bits = num_data_bits;
+    l->stop_bits = stop_bits;
+    l->bits_left = 0;
+    l->frame = 0;
+    l->uart_tx_empty_callback_fptr = uart_tx_empty_callback_fptr;
+    l->app_data = app_data;
+    uart_ring_init(&l->buffer, buffer, buffer_size_plus_one);
+
+    ctx->line_mask |= 1 << line;
+}
+
+/**
+ * Loads the next frame of a line, LSb first starting with the start bit.
+ * Returns the number of bits in the frame.
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_tx_multi_load_frame(uart_tx_multi_line_t *l, uint8_t data){
+    uint32_t n = l->num_data_bits;
+    uint32_t frame = ((uint32_t)data & ((1 << n) - 1)) << 1; //Start bit is 0
+    uint32_t frame_bits = 1 + n;
+    if(l->parity != UART_PARITY_NONE){
+        frame |= uart_parity_bit(data, l->parity) << frame_bits;
+        frame_bits += 1;
+    }
+    frame |= ((1 << l->stop_bits) - 1) << frame_bits;
+    frame_bits += l->stop_bits;
+    l->frame = frame;
+    return frame_bits;
+}
+
+/**
+ * Returns the next bit of a line, starting a new frame or going idle as needed
+ */
+__attribute__((always_inline))
+static inline uint32_t uart_tx_multi_line_bit(uart_tx_multi_line_t *l){
+    if(l->bits_left == 0){
+        uint8_t data;
+        if(uart_ring_pop_byte(&l->buffer, &data) == UART_BUFFER_OK){
+            l->bits_left = uart_tx_multi_load_frame(l, data);
+            l->state = UART_DATA;
+        } else {
+            if(l->state != UART_IDLE){
+                l->state = UART_IDLE;
+                if(l->uart_tx_empty_callback_fptr != NULL){
+                    (*l->uart_tx_empty_callback_fptr)(l->app_data);
+                }
+            }
+            return 1;
+        }
+    }
+    uint32_t bit = l->frame & 0x1;
+    l->frame >>= 1;
+    l->bits_left -= 1;
+    return bit;
+}
+
+void uart_tx_multi(uart_tx_multi_t *ctx){
+    const uint32_t idle_word = ((1 << ctx->port_width) - 1) & ~ctx->line_mask;
+
+    port_out(ctx->tx_port, (1 << ctx->port_width) - 1);
+    port_sync(ctx->tx_port);
+    uint32_t bit_time_acc = 0;
+    uint32_t next_time = port_get_trigger_time(ctx->tx_port) + ctx->bit_time_ticks;
+
+    for(;;){
+        //Build the next word while the previous bit is on the pins
+        uint32_t word = idle_word;
+        uint32_t lines = ctx->line_mask;
+        while(lines){
+            unsigned line = 31 - clz(lines);
+            lines &= ~(1 << line);
+            word |= uart_tx_multi_line_bit(&ctx->line[line]) << line;
+        }
+        port_out_at_time(ctx->tx_port, next_time & 0xffff, word);
+        next_time += uart_next_bit_ticks(&bit_time_acc, ctx->bit_time_ticks, ctx->bit_time_frac);
+    }
+}
+
+uart_buffer_error_t uart_tx_multi_write(uart_tx_multi_t *ctx, unsigned line, uint8_t data){
+    xassert(line < UART_TX_MULTI_MAX_LINES);
+    return uart_ring_push_byte(&ctx->line[line].buffer, data);
+}
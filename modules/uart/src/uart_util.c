@@ -3,6 +3,7 @@
 
 #include "uart_util.h"
 #include <string.h>
+#include <xcore/assert.h>
 
 void init_buffer(uart_buffer_t *buff_cfg, uint8_t *storage_array, unsigned size_plus_one){
     buff_cfg->buffer = storage_array;
@@ -55,3 +56,220 @@ uart_buffer_error_t pop_byte_from_buffer(uart_buffer_t *buff_cfg, uint8_t *data)
     return UART_BUFFER_OK;
 }
 
+void uart_ring_init(uart_ring_t *ring, uint8_t *storage_array, size_t size){
+    size_t capacity = 0;
+    if(storage_array != NULL && size != 0){
+        capacity = 1;
+        while(capacity <= size / 2){
+            capacity <<= 1;
+        }
+    }
+    ring->buffer = capacity ? storage_array : NULL;
+    ring->mask = capacity - 1;
+    ring->write_idx = 0;
+    ring->read_idx = 0;
+}
+
+uint8_t *uart_ring_reserve(uart_ring_t *ring, size_t n, size_t *len){
+    unsigned write_idx = ring->write_idx;
+    unsigned offset = write_idx & ring->mask;
+    size_t space = uart_ring_capacity(ring) - (write_idx - ring->read_idx);
+    size_t to_end = uart_ring_capacity(ring) - offset;
+    if(n > space){
+        n = space;
+    }
+    if(n > to_end){
+        n = to_end;
+    }
+    *len = n;
+    return &ring->buffer[offset];
+}
+
+const uint8_t *uart_ring_peek(uart_ring_t *ring, size_t n, size_t *len){
+    unsigned read_idx = ring->read_idx;
+    unsigned offset = read_idx & ring->mask;
+    size_t fill_level = ring->write_idx - read_idx;
+    size_t to_end = uart_ring_capacity(ring) - offset;
+    if(n > fill_level){
+        n = fill_level;
+    }
+    if(n > to_end){
+        n = to_end;
+    }
+    *len = n;
+    return &ring->buffer[offset];
+}
+
+size_t uart_ring_push(uart_ring_t *ring, const uint8_t *data, size_t n){
+    size_t done = 0;
+    for(int chunk = 0; chunk < 2 && done < n; chunk++){
+        size_t len = 0;
+        uint8_t *dst = uart_ring_reserve(ring, n - done, &len);
+        memcpy(dst, &data[done], len);
+        uart_ring_commit(ring, len); //Data first so valid after commit
+        done += len;
+    }
+    return done;
+}
+
+size_t uart_ring_pop(uart_ring_t *ring, uint8_t *data, size_t n){
+    size_t done = 0;
+    for(int chunk = 0; chunk < 2 && done < n; chunk++){
+        size_t len = 0;
+        const uint8_t *src = uart_ring_peek(ring, n - done, &len);
+        memcpy(&data[done], src, len);
+        uart_ring_release(ring, len);
+        done += len;
+    }
+    return done;
+}
+
+#define SLIP_END        0xC0
+#define SLIP_ESC        0xDB
+#define SLIP_ESC_END    0xDC
+#define SLIP_ESC_ESC    0xDD
+
+void uart_deframer_init(uart_deframer_t *deframer, uart_framing_t type, uint8_t *packet, size_t packet_size){
+    deframer->type = type;
+    deframer->packet = packet;
+    deframer->packet_size = packet_size;
+    deframer->len = 0;
+    deframer->pos = 0;
+    deframer->escape = 0;
+    deframer->code = 0;
+    deframer->left = 0;
+    deframer->dropping = 0;
+}
+
+static uart_deframe_result_t uart_deframer_end(uart_deframer_t *deframer, unsigned complete){
+    unsigned dropping = deframer->dropping;
+    size_t len = deframer->pos;
+    deframer->pos = 0;
+    deframer->escape = 0;
+    deframer->code = 0;
+    deframer->left = 0;
+    deframer->dropping = 0;
+    if(dropping){
+        return UART_DEFRAME_MORE; //Error already reported
+    }
+    if(!complete){
+        return UART_DEFRAME_ERROR;
+    }
+    if(len == 0){
+        return UART_DEFRAME_MORE; //Eg. SLIP END sent before each packet
+    }
+    deframer->len = len;
+    return UART_DEFRAME_PACKET;
+}
+
+static inline uart_deframe_result_t uart_deframer_drop(uart_deframer_t *deframer){
+    deframer->dropping = 1;
+    return UART_DEFRAME_ERROR;
+}
+
+static inline uart_deframe_result_t uart_deframer_store(uart_deframer_t *deframer, uint8_t data){
+    if(deframer->pos == deframer->packet_size){
+        return uart_deframer_drop(deframer);
+    }
+    deframer->packet[deframer->pos++] = data;
+    return UART_DEFRAME_MORE;
+}
+
+uart_deframe_result_t uart_deframer_push(uart_deframer_t *deframer, uint8_t data){
+    if(deframer->type == UART_FRAMING_SLIP){
+        if(data == SLIP_END){
+            return uart_deframer_end(deframer, !deframer->escape);
+        }
+        if(deframer->dropping){
+            return UART_DEFRAME_MORE;
+        }
+        if(deframer->escape){
+            deframer->escape = 0;
+            if(data == SLIP_ESC_END){
+                return uart_deframer_store(deframer, SLIP_END);
+            } else if(data == SLIP_ESC_ESC){
+                return uart_deframer_store(deframer, SLIP_ESC);
+            }
+            return uart_deframer_drop(deframer);
+        }
+        if(data == SLIP_ESC){
+            deframer->escape = 1;
+            return UART_DEFRAME_MORE;
+        }
+        return uart_deframer_store(deframer, data);
+    }
+
+    //COBS. Each block is a code byte then code - 1 data bytes. A zero follows
+    //every block with a code below 0xFF except the last, so it is only stored
+    //once the next block starts.
+    if(data == 0){
+        return uart_deframer_end(deframer, deframer->left == 0);
+    }
+    if(deframer->dropping){
+        return UART_DEFRAME_MORE;
+    }
+    if(deframer->left){
+        deframer->left -= 1;
+        return uart_deframer_store(deframer, data);
+    }
+    uart_deframe_result_t result = UART_DEFRAME_MORE;
+    if(deframer->code && deframer->code != 0xFF){
+        result = uart_deframer_store(deframer, 0);
+    }
+    deframer->code = data;
+    deframer->left = data - 1;
+    return result;
+}
+
+static inline uint32_t uart_crc_reflect(uint32_t value, uint8_t width){
+    return bitrev(value) >> (32 - width);
+}
+
+void uart_crc_init(uart_crc_t *crc, uint8_t width, uint32_t poly, uint32_t init, uint32_t xor_out, unsigned reflected){
+    xassert(width == 8 || width == 16 || width == 32);
+    uint32_t mask = 0xffffffff >> (32 - width);
+    crc->width = width;
+    crc->reflected = reflected != 0;
+    crc->poly = uart_crc_reflect(poly & mask, width);
+    crc->init = uart_crc_reflect(init & mask, width);
+    crc->xor_out = xor_out & mask;
+
+    //Run a message of no bytes followed by its CRC to find what a good message leaves
+    uint8_t bytes[4];
+    uart_crc_reset(crc);
+    size_t n = uart_crc_get_bytes(crc, bytes);
+    for(size_t i = 0; i < n; i++){
+        uart_crc_update(crc, bytes[i]);
+    }
+    crc->residue = uart_crc_result(crc);
+    uart_crc_reset(crc);
+}
+
+void uart_crc_init_preset(uart_crc_t *crc, uart_crc_preset_t preset){
+    switch(preset){
+        case UART_CRC_8:
+            uart_crc_init(crc, 8, 0x07, 0x00, 0x00, 0);
+            break;
+        case UART_CRC_16_CCITT:
+            uart_crc_init(crc, 16, 0x1021, 0xffff, 0x0000, 0);
+            break;
+        case UART_CRC_16_MODBUS:
+            uart_crc_init(crc, 16, 0x8005, 0xffff, 0x0000, 1);
+            break;
+        case UART_CRC_32:
+            uart_crc_init(crc, 32, 0x04c11db7, 0xffffffff, 0xffffffff, 1);
+            break;
+        default:
+            xassert(0);
+    }
+}
+
+size_t uart_crc_get_bytes(uart_crc_t *crc, uint8_t *bytes){
+    uint32_t value = uart_crc_result(crc);
+    size_t n = crc->width / 8;
+    for(size_t i = 0; i < n; i++){
+        unsigned shift = crc->reflected ? 8 * i : 8 * (n - 1 - i);
+        bytes[i] = value >> shift;
+    }
+    return n;
+}
@@ -2,12 +2,14 @@
 // This Software is subject to the terms of the XMOS Public Licence: Version 1.
 
 /**
- * This file contains the prototypes for the FIFO used by the buffered UART modes (bare metal only)
+ * This file contains the prototypes for the FIFO, the packet deframer and the
+ * running CRC used by the buffered UART modes (bare metal only)
  */
 
 #pragma once
 #include <stddef.h>
 #include <stdint.h>
+#include <xclib.h>
 
 typedef enum {
     UART_BUFFER_OK = 0,
@@ -47,3 +49,262 @@ __attribute__((always_inline))
 inline int buffer_used(uart_buffer_t *buff_cfg){
     return(buff_cfg->buffer != NULL);
 }
+
+/**
+ * A single producer, single consumer ring with a power of two capacity. The
+ * indices run freely and are masked on access, so push, pop and the fill level
+ * need no wrap checks. It is safe for one producer and one consumer, eg. an ISR
+ * and a thread, without locks or masking interrupts. Unlike uart_buffer_t it
+ * does not need an extra slot.
+ */
+typedef struct {
+    uint8_t * buffer;
+    unsigned mask;
+    volatile unsigned write_idx;
+    volatile unsigned read_idx;
+} uart_ring_t;
+
+/**
+ * Initialises the ring. The storage is not cleared.
+ *
+ * \param ring          The ring context to initialise.
+ * \param storage_array The storage for the ring, or NULL for no ring.
+ * \param size          The size of the storage array. The capacity of the ring
+ *                      is the largest power of two which fits, eg. 64 for 65.
+ */
+void uart_ring_init(uart_ring_t *ring, uint8_t *storage_array, size_t size);
+
+/**
+ * Gets a pointer to up to n contiguous free bytes in the ring to write into.
+ * Only the producer may call this. The bytes are added with uart_ring_commit().
+ *
+ * \param ring          The ring context.
+ * \param n             The maximum number of bytes wanted.
+ * \param len           Pointer to where the number of bytes available at the
+ *                      returned pointer is stored. This may be less than n at
+ *                      the end of the storage, or 0 if the ring is full.
+ */
+uint8_t *uart_ring_reserve(uart_ring_t *ring, size_t n, size_t *len);
+
+/**
+ * Gets a pointer to up to n contiguous bytes at the head of the ring to read in
+ * place. Only the consumer may call this. The bytes are removed with
+ * uart_ring_release().
+ *
+ * \param ring          The ring context.
+ * \param n             The maximum number of bytes wanted.
+ * \param len           Pointer to where the number of bytes available at the
+ *                      returned pointer is stored. This may be less than n at
+ *                      the end of the storage, or 0 if the ring is empty.
+ */
+const uint8_t *uart_ring_peek(uart_ring_t *ring, size_t n, size_t *len);
+
+/**
+ * Copies up to n bytes into the ring in at most two contiguous chunks.
+ * Returns the number of bytes actually pushed, which is less than n if the ring fills.
+ */
+size_t uart_ring_push(uart_ring_t *ring, const uint8_t *data, size_t n);
+
+/**
+ * Copies up to n bytes out of the ring in at most two contiguous chunks.
+ * Returns the number of bytes actually popped, which is less than n if the ring empties.
+ */
+size_t uart_ring_pop(uart_ring_t *ring, uint8_t *data, size_t n);
+
+__attribute__((always_inline))
+inline int uart_ring_used(uart_ring_t *ring){
+    return(ring->buffer != NULL);
+}
+
+__attribute__((always_inline))
+inline unsigned uart_ring_fill_level(uart_ring_t *ring){
+    return ring->write_idx - ring->read_idx;
+}
+
+__attribute__((always_inline))
+inline size_t uart_ring_capacity(uart_ring_t *ring){
+    return ring->mask + 1;
+}
+
+/**
+ * Adds n bytes written via uart_ring_reserve() to the ring.
+ */
+__attribute__((always_inline))
+inline void uart_ring_commit(uart_ring_t *ring, size_t n){
+    ring->write_idx += n;
+}
+
+/**
+ * Removes n bytes read via uart_ring_peek() from the ring.
+ */
+__attribute__((always_inline))
+inline void uart_ring_release(uart_ring_t *ring, size_t n){
+    ring->read_idx += n;
+}
+
+__attribute__((always_inline))
+inline uart_buffer_error_t uart_ring_push_byte(uart_ring_t *ring, uint8_t data){
+    unsigned write_idx = ring->write_idx;
+    if(write_idx - ring->read_idx > ring->mask){
+        return UART_BUFFER_FULL;
+    }
+    ring->buffer[write_idx & ring->mask] = data; //Data first so valid after idx++
+    ring->write_idx = write_idx + 1;
+    return UART_BUFFER_OK;
+}
+
+__attribute__((always_inline))
+inline uart_buffer_error_t uart_ring_pop_byte(uart_ring_t *ring, uint8_t *data){
+    unsigned read_idx = ring->read_idx;
+    if(read_idx == ring->write_idx){
+        return UART_BUFFER_EMPTY;
+    }
+    *data = ring->buffer[read_idx & ring->mask];
+    ring->read_idx = read_idx + 1;
+    return UART_BUFFER_OK;
+}
+
+typedef enum {
+    UART_FRAMING_NONE = 0,
+    UART_FRAMING_SLIP,      //RFC 1055, packets end with 0xC0
+    UART_FRAMING_COBS       //Consistent overhead byte stuffing, packets end with 0x00
+} uart_framing_t;
+
+typedef enum {
+    UART_DEFRAME_MORE = 0,  //Byte taken, packet not complete
+    UART_DEFRAME_PACKET,    //Packet complete
+    UART_DEFRAME_ERROR      //Packet dropped: bad encoding or too long
+} uart_deframe_result_t;
+
+/**
+ * An incremental SLIP or COBS decoder writing straight into a packet buffer.
+ * After an error the rest of the packet is dropped, up to the next delimiter.
+ */
+typedef struct {
+    uart_framing_t type;
+    uint8_t *packet;
+    size_t packet_size;
+    size_t len;         //Length of the last packet decoded
+    size_t pos;         //Bytes decoded so far of the current packet
+    unsigned escape;    //SLIP: last byte was ESC
+    unsigned code;      //COBS: code byte of the current block
+    unsigned left;      //COBS: data bytes left in the current block
+    unsigned dropping;
+} uart_deframer_t;
+
+/**
+ * Initialises the deframer.
+ *
+ * \param deframer      The deframer context to initialise.
+ * \param type          The packet framing used.
+ * \param packet        The buffer decoded packets are written to.
+ * \param packet_size   The size of the packet buffer.
+ */
+void uart_deframer_init(uart_deframer_t *deframer, uart_framing_t type, uint8_t *packet, size_t packet_size);
+
+/**
+ * Decodes the next received byte.
+ *
+ * Returns UART_DEFRAME_PACKET when the byte completes a packet, which is then
+ * deframer->len bytes in deframer->packet. Decoding of the next packet starts
+ * at the start of the buffer, which may be swapped with uart_deframer_set_packet()
+ * first. Empty packets are skipped.
+ */
+uart_deframe_result_t uart_deframer_push(uart_deframer_t *deframer, uint8_t data);
+
+/**
+ * Sets the buffer the next packet is decoded into.
+ */
+__attribute__((always_inline))
+inline void uart_deframer_set_packet(uart_deframer_t *deframer, uint8_t *packet){
+    deframer->packet = packet;
+}
+
+typedef enum {
+    UART_CRC_8 = 0,         //Poly 0x07, init 0x00, not reflected
+    UART_CRC_16_CCITT,      //Poly 0x1021, init 0xFFFF, not reflected
+    UART_CRC_16_MODBUS,     //Poly 0x8005, init 0xFFFF, reflected
+    UART_CRC_32             //Poly 0x04C11DB7, init and xor out 0xFFFFFFFF, reflected
+} uart_crc_preset_t;
+
+/**
+ * A running CRC updated a byte at a time with the crc8 instruction. The crc8
+ * instruction shifts right, so the register is always held reflected. CRCs
+ * which are not reflected are run with each byte bit reversed and the result
+ * reversed back. A width of zero means disabled.
+ */
+typedef struct {
+    uint32_t poly;      //Reflected and right aligned
+    uint32_t init;      //Reflected
+    uint32_t xor_out;
+    uint32_t residue;   //Value after a message followed by its own CRC
+    uint32_t value;     //Running register, reflected
+    uint8_t width;
+    uint8_t reflected;
+} uart_crc_t;
+
+/**
+ * Initialises a CRC with any polynomial. The parameters are given as in the
+ * usual CRC catalogues, eg. CRC-16/XMODEM is 16, 0x1021, 0, 0, 0.
+ *
+ * \param crc           The CRC context to initialise.
+ * \param width         The CRC width in bits, 8, 16 or 32.
+ * \param poly          The polynomial, not reflected, without the top bit.
+ * \param init          The initial register value, not reflected.
+ * \param xor_out       The value XORed with the register to give the CRC.
+ * \param reflected     Non-zero if bytes are processed LSb first and the
+ *                      result is reflected, zero for MSb first.
+ */
+void uart_crc_init(uart_crc_t *crc, uint8_t width, uint32_t poly, uint32_t init, uint32_t xor_out, unsigned reflected);
+
+/**
+ * Initialises a CRC to one of the common presets.
+ */
+void uart_crc_init_preset(uart_crc_t *crc, uart_crc_preset_t preset);
+
+/**
+ * Starts a new message.
+ */
+__attribute__((always_inline))
+inline void uart_crc_reset(uart_crc_t *crc){
+    crc->value = crc->init;
+}
+
+/**
+ * Adds a byte to the running CRC.
+ */
+__attribute__((always_inline))
+inline void uart_crc_update(uart_crc_t *crc, uint8_t data){
+    uint32_t d = crc->reflected ? data : bitrev(data) >> 24;
+    //crc8 shifts its data operand in at the top, so the byte is XORed into the
+    //register and zeros shifted in instead
+    uint32_t value = crc->value ^ d;
+    uint32_t rest;
+    asm volatile("crc8 %0, %1, %3, %4" : "=r" (value), "=r" (rest) : "0" (value), "r" (0), "r" (crc->poly));
+    crc->value = value;
+}
+
+/**
+ * Returns the CRC of the bytes added since the last reset.
+ */
+__attribute__((always_inline))
+inline uint32_t uart_crc_result(uart_crc_t *crc){
+    uint32_t value = crc->reflected ? crc->value : bitrev(crc->value) >> (32 - crc->width);
+    return value ^ crc->xor_out;
+}
+
+/**
+ * Returns the result of a good message followed by its own CRC, sent as by
+ * uart_crc_get_bytes(). This is zero for CRCs without an xor_out.
+ */
+__attribute__((always_inline))
+inline uint32_t uart_crc_residue(const uart_crc_t *crc){
+    return crc->residue;
+}
+
+/**
+ * Gets the current CRC as bytes in the order they are sent after the message:
+ * LSB first for reflected CRCs and MSB first otherwise. Returns the number of
+ * bytes, which is the width / 8.
+ */
+size_t uart_crc_get_bytes(uart_crc_t *crc, uint8_t *bytes);
@@ -18,6 +18,11 @@ then
 "test_hil_uart_fifo_test XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_fifo_thread_safe_test XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 
+################################### UART LOOPBACK ######################################################
+"test_hil_uart_loopback_test_hs_12500000 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_loopback_test_hs_6250000 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_loopback_test_hs_3125000 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+
 ################################### UART TX ############################################################
 "test_hil_uart_tx_test_UNBUFFERED_1152000_8_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_tx_test_UNBUFFERED_1152000_8_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
@@ -115,6 +120,30 @@ then
 "test_hil_uart_tx_test_BUFFERED_9600_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_tx_test_BUFFERED_9600_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_tx_test_BUFFERED_9600_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_8_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_UNBUFFERED_2400_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_8_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_test_BUFFERED_2400_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 
 
 ################################### UART RX ############################################################
@@ -214,8 +243,59 @@ then
 "test_hil_uart_rx_test_BUFFERED_9600_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_rx_test_BUFFERED_9600_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 "test_hil_uart_rx_test_BUFFERED_9600_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_8_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_UNBUFFERED_2400_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_8_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_NONE_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_NONE_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_EVEN_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_EVEN_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_ODD_1 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_test_BUFFERED_2400_5_ODD_2 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+
 
+################################### UART TX FEATURES ###################################################
+"test_hil_uart_tx_features_test_rs485 XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_blocking_return XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_multi_producer XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_crc XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_clocked XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_multi XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_watermark XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_fractional XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_cts XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_tx_features_test_backpressure XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 
+################################### UART RX FEATURES ###################################################
+"test_hil_uart_rx_features_test_autobaud XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_multidrop XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_crc XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_define_isr XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_oversampled XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_multi XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_idle_timeout XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_watermark XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_rts XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_stats XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_event XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_timestamps XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_majority_vote XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
+"test_hil_uart_rx_features_test_stream XCORE-AI-EXPLORER xmos_cmake_toolchain/xs3a.cmake"
 )
 elif [ "$1" == "smoke" ]
 then
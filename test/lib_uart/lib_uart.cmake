@@ -1,5 +1,7 @@
 include(${CMAKE_CURRENT_LIST_DIR}/uart_test_tx/uart_test_tx.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/uart_test_tx_features/uart_test_tx_features.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/uart_test_rx/uart_test_rx.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/uart_test_rx_features/uart_test_rx_features.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/uart_test_fifo/uart_test_fifo.cmake)
 include(${CMAKE_CURRENT_LIST_DIR}/uart_test_fifo_thread_safe/uart_test_fifo_thread_safe.cmake)
-# include(${CMAKE_CURRENT_LIST_DIR}/uart_test_loopback/uart_test_loopback.cmake)
+include(${CMAKE_CURRENT_LIST_DIR}/uart_test_loopback/uart_test_loopback.cmake)
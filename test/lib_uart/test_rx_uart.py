@@ -15,7 +15,8 @@ speed_args = {
               "700000 baud": 700000,
               "422400 baud": 422400,
               "115200 baud": 115200,
-              "9600 baud": 9600
+              "9600 baud": 9600,
+              "2400 baud": 2400  #Below 3052 baud bits are timed on the hwtimer rather than the port timer
               }
 
 data_bit_args = {   "eight": 8,            
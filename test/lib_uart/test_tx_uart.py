@@ -14,7 +14,8 @@ speed_args = {
               "1152000 baud": 1152000,
               "576000 baud": 576000,
               "115200 baud": 115200,
-              "9600 baud": 9600
+              "9600 baud": 9600,
+              "2400 baud": 2400  #Below 3052 baud bits are timed on the hwtimer rather than the port timer
               }
 
 data_bit_args = {   "eight": 8,            
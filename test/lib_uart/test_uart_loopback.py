@@ -0,0 +1,32 @@
+#!/usr/bin/env python
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from uart_tx_checker import UARTLoopbackRateChecker
+from pathlib import Path
+import Pyxsim as px
+import pytest
+
+tx_port = "tile[0]:XS1_PORT_1A"
+rx_port = "tile[0]:XS1_PORT_1B"
+
+# 12.5MHz / n for n = 1, 2 and 4
+hs_bauds = [12500000, 6250000, 3125000]
+
+@pytest.mark.parametrize("baud", hs_bauds)
+def test_uart_hs_loopback(request, capfd, baud):
+    cwd = Path(request.fspath).parent
+
+    binary = f'{cwd}/uart_test_loopback/bin/test_hil_uart_loopback_test_hs_{baud}.xe'
+    assert Path(binary).exists()
+
+    checker = UARTLoopbackRateChecker(tx_port, rx_port, baud, 64)
+    tester = px.testers.PytestComparisonTester(f'{cwd}/expected/test_loopback_hs.expect',
+                                            regexp = False,
+                                            ordered = True,
+                                            ignore = ["Interesting stats.*"])
+
+    px.run_with_pyxsim(binary, simthreads = [checker])
+    capture = capfd.readouterr().out[:-1] #Tester appends an extra line feed which we don't need
+
+    tester.run(capture)
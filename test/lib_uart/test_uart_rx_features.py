@@ -0,0 +1,135 @@
+#!/usr/bin/env python
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from uart_rx_checker import UARTRxChecker, UARTRxMultiChecker
+from pathlib import Path
+import Pyxsim as px
+import pytest
+
+tx_port = "tile[0]:XS1_PORT_1A" #Used for synch to start checker
+rx_port = "tile[0]:XS1_PORT_1B"
+
+parity_none = 0 #Checker parity value for UART_PARITY_NONE
+
+def run_rx_feature(request, capfd, feature, simthreads):
+    cwd = Path(request.fspath).parent
+
+    binary = f'{cwd}/uart_test_rx_features/bin/test_hil_uart_rx_features_test_{feature}.xe'
+    assert Path(binary).exists()
+
+    tester = px.testers.PytestComparisonTester(f'{cwd}/expected/test_rx_features_{feature}.expect',
+                                            regexp = False,
+                                            ordered = True,
+                                            ignore = ["TEST CONFIG:.*", "Interesting stats.*"])
+
+    simargs = ['--weak-external-drive']
+    px.run_with_pyxsim(binary, simthreads = simthreads, simargs=simargs)
+    capture = capfd.readouterr().out[:-1] #Tester appends an extra line feed which we don't need
+
+    tester.run(capture)
+
+
+def test_uart_rx_autobaud(request, capfd):
+    #The app starts at 9600 baud and must detect the rate from the 0x55 preamble
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=[0x55, 0x00, 0x08, 0xaa])
+    run_rx_feature(request, capfd, "autobaud", [checker])
+
+
+def test_uart_rx_define_isr(request, capfd):
+    #A generic and a UART_RX_DEFINE() Rx get the same bytes at once, and the ISR lengths are compared
+    data = [0x00, 0x5a, 0xff, 0xa5]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data)
+    checker_define = UARTRxChecker("tile[0]:XS1_PORT_1C", tx_port, parity_none, 115200, 1, 8, data=data)
+    run_rx_feature(request, capfd, "define_isr", [checker, checker_define])
+
+
+def test_uart_rx_multidrop(request, capfd):
+    #9 bit frames with the address mark in bit 8. The app is node 1 so the frames for node 2 are dropped
+    data = [0x101, 0x11, 0x12, 0x102, 0x21, 0x101, 0x13]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 9, data=data)
+    run_rx_feature(request, capfd, "multidrop", [checker])
+
+
+def test_uart_rx_crc(request, capfd):
+    #A good Modbus RTU packet, whose CRC residue is zero, then one with a corrupt CRC byte
+    good = [0x01, 0x03, 0x00, 0x00, 0x00, 0x01, 0x84, 0x0a]
+    bad = good[:-1] + [0x0b]
+    gap_ps = 500 * 1000000 #Well over the 20 bit idle timeout at 115200
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=good + bad, gaps={len(good): gap_ps})
+    run_rx_feature(request, capfd, "crc", [checker])
+
+
+def test_uart_rx_oversampled(request, capfd):
+    #8x at 921600 on 1B, not a whole number of samples per bit, and 16x at 115200 on 1C
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 921600, 1, 8, data=[0x00, 0x5a, 0xff, 0xa5])
+    checker_16x = UARTRxChecker("tile[0]:XS1_PORT_1C", tx_port, parity_none, 115200, 1, 8, data=[0x55, 0xc3, 0x3c, 0x01])
+    run_rx_feature(request, capfd, "oversampled", [checker, checker_16x])
+
+
+def test_uart_rx_multi(request, capfd):
+    #Three lines at different rates on bits 0, 1 and 3 of a 4b port, all sending at once
+    lines = [(0, 115200, [0x00, 0x5a, 0xff, 0xa5]),
+             (1, 57600, [0x55, 0xc3, 0x3c, 0x01]),
+             (3, 38400, [0x80, 0x7e, 0x11, 0xee])]
+    checker = UARTRxMultiChecker("tile[0]:XS1_PORT_4A", tx_port, 4, lines)
+    run_rx_feature(request, capfd, "multi", [checker])
+
+
+def test_uart_rx_idle_timeout(request, capfd):
+    #Packets of 3, 5 and 1 bytes ended by the 10 bit idle timeout, with a 5 bit gap inside the second
+    bit_ps = 1e12 / 115200
+    data = [0x01, 0x02, 0x03, 0x11, 0x12, 0x13, 0x14, 0x15, 0x21]
+    gaps = {3: 30 * bit_ps, 6: 5 * bit_ps, 8: 30 * bit_ps}
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data, gaps=gaps)
+    run_rx_feature(request, capfd, "idle_timeout", [checker])
+
+
+def test_uart_rx_watermark(request, capfd):
+    #Two batches of 4 drained at the high watermark, then 2 words which do not reach it
+    bit_ps = 1e12 / 115200
+    data = [0x10, 0x11, 0x12, 0x13, 0x20, 0x21, 0x22, 0x23, 0x30, 0x31]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data, gaps={4: 20 * bit_ps})
+    run_rx_feature(request, capfd, "watermark", [checker])
+
+
+def test_uart_rx_rts(request, capfd):
+    #The checker only starts a frame while RTS is asserted. The app holds off reading at the high watermark of 4
+    data = [0x10, 0x11, 0x12, 0x13, 0x20, 0x21, 0x22, 0x23]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data, rts_port="tile[0]:XS1_PORT_1C")
+    run_rx_feature(request, capfd, "rts", [checker])
+
+
+def test_uart_rx_stats(request, capfd):
+    #Six words into a four word buffer, read five times, then three words from a Tx. See rx_stats.c
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=[0x01, 0x02, 0x03, 0x04, 0x05, 0x06])
+    run_rx_feature(request, capfd, "stats", [checker])
+
+
+def test_uart_rx_event(request, capfd):
+    #Two event driven UARTs at 115200 on 1B and 57600 on 1C and a timer served from one thread
+    checker_a = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=[0x00, 0x5a, 0xff, 0xa5])
+    checker_b = UARTRxChecker("tile[0]:XS1_PORT_1C", tx_port, parity_none, 57600, 1, 8, data=[0x55, 0xc3, 0x3c, 0x01])
+    run_rx_feature(request, capfd, "event", [checker_a, checker_b])
+
+
+def test_uart_rx_timestamps(request, capfd):
+    #Two frames back to back, then 100us and 200us of idle line before the next two. See rx_timestamps.c
+    gaps = {2: 100 * 1000000, 3: 200 * 1000000}
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=[0x10, 0x20, 0x30, 0x40], gaps=gaps)
+    run_rx_feature(request, capfd, "timestamps", [checker])
+
+
+def test_uart_rx_majority_vote(request, capfd):
+    #1us glitches in the middle of bits 2 and 7 of the second word and bit 5 of the fourth
+    data = [0x55, 0x0f, 0xa5, 0x3c]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data,
+                            glitches={1: [2, 7], 3: [5]}, glitch_ps=1000000)
+    run_rx_feature(request, capfd, "majority_vote", [checker])
+
+
+def test_uart_rx_stream(request, capfd):
+    #Bursts of 6 and 8 bytes streamed over a channel, each ended by the 10 bit idle timeout
+    data = [0x01, 0x02, 0x03, 0x04, 0x05, 0x06] + [0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18]
+    checker = UARTRxChecker(rx_port, tx_port, parity_none, 115200, 1, 8, data=data, gaps={6: 100 * 1000000})
+    run_rx_feature(request, capfd, "stream", [checker])
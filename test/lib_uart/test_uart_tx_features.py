@@ -0,0 +1,92 @@
+#!/usr/bin/env python
+# Copyright 2022 XMOS LIMITED.
+# This Software is subject to the terms of the XMOS Public Licence: Version 1.
+
+from uart_tx_checker import UARTTxChecker, UARTDEChecker, UARTTxReturnChecker, UARTTxMessageChecker, UARTTxCRCChecker, \
+    UARTTxRunChecker, UARTTxMultiChecker, UARTTxRateChecker, UARTTxCTSChecker
+from pathlib import Path
+import Pyxsim as px
+import pytest
+
+tx_port = "tile[0]:XS1_PORT_1A"
+
+def run_tx_feature(request, capfd, feature, simthreads):
+    cwd = Path(request.fspath).parent
+
+    binary = f'{cwd}/uart_test_tx_features/bin/test_hil_uart_tx_features_test_{feature}.xe'
+    assert Path(binary).exists()
+
+    tester = px.testers.PytestComparisonTester(f'{cwd}/expected/test_tx_features_{feature}.expect',
+                                            regexp = False,
+                                            ordered = True,
+                                            ignore = ["TEST CONFIG:.*", "Interesting stats.*"])
+
+    simargs = []
+    px.run_with_pyxsim(binary, simthreads = simthreads, simargs=simargs)
+    capture = capfd.readouterr().out[:-1] #Tester appends an extra line feed which we don't need
+
+    tester.run(capture)
+
+
+def test_uart_tx_rs485(request, capfd):
+    #Port timed, port timed with a long bit time, and timer driven. See tx_rs485.c
+    de_port = "tile[0]:XS1_PORT_1B"
+    runs = [(115200, 2), (4800, 1), (2400, 1)]
+    checker = UARTDEChecker(tx_port, de_port, runs, lead_ps=5000000)
+    run_tx_feature(request, capfd, "rs485", [checker])
+
+
+def test_uart_tx_blocking_return(request, capfd):
+    #Port timed and timer driven. See tx_blocking_return.c
+    marker_port = "tile[0]:XS1_PORT_1B"
+    checker = UARTTxReturnChecker(tx_port, marker_port, [115200, 2400])
+    run_tx_feature(request, capfd, "blocking_return", [checker])
+
+
+def test_uart_tx_multi_producer(request, capfd):
+    #Two producer threads each queue their message twice. See tx_multi_producer.c
+    messages = [[0xa0, 0xa1, 0xa2, 0xa3]] * 2 + [[0xb0, 0xb1, 0xb2, 0xb3]] * 2
+    checker = UARTTxMessageChecker(tx_port, 115200, messages)
+    run_tx_feature(request, capfd, "multi_producer", [checker])
+
+
+def test_uart_tx_crc(request, capfd):
+    #Buffered with words dropped by a full buffer, then blocking. See tx_crc.c
+    checker = UARTTxCRCChecker(tx_port, 115200, 2)
+    run_tx_feature(request, capfd, "crc", [checker])
+
+
+def test_uart_tx_clocked(request, capfd):
+    #Buffered at 1Mbaud then blocking at 115200. See tx_clocked.c
+    checker = UARTTxRunChecker(tx_port, [(1000000, 4), (115200, 2)])
+    run_tx_feature(request, capfd, "clocked", [checker])
+
+
+def test_uart_tx_multi(request, capfd):
+    #Three lines on bits 0, 1 and 3 of a 4b port with 4, 2 and 3 bytes to send. See tx_multi.c
+    checker = UARTTxMultiChecker("tile[0]:XS1_PORT_4C", 115200, [(0, 4), (1, 2), (3, 3)])
+    run_tx_feature(request, capfd, "multi", [checker])
+
+
+def test_uart_tx_watermark(request, capfd):
+    #24 bytes through an 8 byte buffer refilled at the low watermark. See tx_watermark.c
+    checker = UARTTxRunChecker(tx_port, [(115200, 24)])
+    run_tx_feature(request, capfd, "watermark", [checker])
+
+
+def test_uart_tx_fractional(request, capfd):
+    #Blocking at 3Mbaud, 33.33 ticks per bit, where a truncated bit time would be 1% short. See tx_fractional.c
+    checker = UARTTxRateChecker(tx_port, 3000000, 16, 0.005)
+    run_tx_feature(request, capfd, "fractional", [checker])
+
+
+def test_uart_tx_cts(request, capfd):
+    #CTS is deasserted during the third frame, which must finish, then held off for 30 bit times. See tx_cts.c
+    checker = UARTTxCTSChecker(tx_port, "tile[0]:XS1_PORT_1B", 115200, 6, 2, 30)
+    run_tx_feature(request, capfd, "cts", [checker])
+
+
+def test_uart_tx_backpressure(request, capfd):
+    #16 bytes with uart_tx_wait() then 8 with uart_tx_try() retried, through a 4 byte buffer. See tx_backpressure.c
+    checker = UARTTxRunChecker(tx_port, [(115200, 24)])
+    run_tx_feature(request, capfd, "backpressure", [checker])
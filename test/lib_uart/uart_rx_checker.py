@@ -3,6 +3,7 @@
 import Pyxsim as px
 from typing import Sequence
 from functools import partial
+from random import randint
 
 # We need to disable output buffering for this test to work on MacOS; this has
 # no effect on Linux systems. Let's redefine print once to avoid putting the 
@@ -29,7 +30,7 @@ class DriveHigh(px.SimThread):
 
 class UARTRxChecker(px.SimThread):
     def __init__(self, rx_port, tx_port, parity, baud, stop_bits, bpb, data=[0x7f, 0x00, 0x2f, 0xff],
-                 intermittent=False):
+                 intermittent=False, gaps=None, rts_port=None, glitches=None, glitch_ps=1000000):
         """
         Create a UARTRxChecker instance.
 
@@ -41,6 +42,13 @@ class UARTRxChecker(px.SimThread):
         :param bpb:        Number of data bits per "byte" of UART data.
         :param data:       A list of bytes to send (default: [0x7f, 0x00, 0x2f, 0xff])
         :param intermittent: Add a random delay between sent bytes.
+        :param gaps:       A dict of byte index to the idle time in ps before
+                           that byte is sent, eg. to end a packet.
+        :param rts_port:   RTS port of the UART device under test. If given, each
+                           byte waits for RTS to be asserted (low).
+        :param glitches:   A dict of byte index to a list of the data bits of
+                           that byte to invert briefly in the middle of the bit.
+        :param glitch_ps:  The width of each glitch in ps.
         """
         self._rx_port = rx_port
         self._tx_port = tx_port
@@ -50,6 +58,11 @@ class UARTRxChecker(px.SimThread):
         self._bits_per_byte = bpb
         self._data = data
         self._intermittent = intermittent
+        self._gaps = gaps if gaps is not None else {}
+        self._rts_port = rts_port
+        self._glitches = glitches if glitches is not None else {}
+        self._glitch_ps = glitch_ps
+        self._glitch_bits = []
         # Hex value of stop bits, as MSB 1st char, e.g. 0b11 : 0xC0
 
     def send_byte(self, xsi, byte):
@@ -93,7 +106,24 @@ class UARTRxChecker(px.SimThread):
             # print "  Sending bit %d of 0x%02x (%d)" % (x, byte, (byte >> x) & 0x01)
             xsi.drive_port_pins(self._rx_port, (byte & (0x01 << x)) >= 1)
             # print "  (x): %d" % ((byte & (0x01 << x))>=1)
-            self.wait_baud_time(xsi)
+            if x in self._glitch_bits:
+                self.send_glitch(xsi, (byte & (0x01 << x)) >= 1)
+            else:
+                self.wait_baud_time(xsi)
+
+    def send_glitch(self, xsi, val):
+        """
+        Drive the rest of a bit with the inverse of its value briefly in the middle.
+
+        :param xsi:        XMOS Simulator Instance.
+        :param val:        The value of the bit.
+        """
+        bit_start = xsi.get_time()
+        self.wait_until(bit_start + (self.get_bit_time() - self._glitch_ps) / 2)
+        xsi.drive_port_pins(self._rx_port, not val)
+        self.wait_until(bit_start + (self.get_bit_time() + self._glitch_ps) / 2)
+        xsi.drive_port_pins(self._rx_port, val)
+        self.wait_until(bit_start + self.get_bit_time())
 
     def send_parity(self, xsi, byte):
         """
@@ -173,5 +203,59 @@ class UARTRxChecker(px.SimThread):
                 self.wait_until(xsi.get_time() + k)
                 self.send_byte(xsi, x)
         else:
-            for x in self._data:
+            for i, x in enumerate(self._data):
+                if i in self._gaps:
+                    self.wait_until(xsi.get_time() + self._gaps[i])
+                if self._rts_port is not None:
+                    self.wait((lambda _x: xsi.is_port_driving(self._rts_port) and
+                               xsi.sample_port_pins(self._rts_port) == 0))
+                self._glitch_bits = self._glitches.get(i, [])
                 self.send_byte(xsi, x)
+
+
+class UARTRxMultiChecker(px.SimThread):
+    """
+    This simulator thread drives several UART lines, each on its own bit of
+    one port and at its own baud rate, all at once. Frames are 8N1.
+    """
+
+    def __init__(self, rx_port, tx_port, port_width, lines):
+        """
+        Create a UARTRxMultiChecker instance.
+
+        :param rx_port:    Receive port of the UART device under test.
+        :param tx_port:    Port driven by the device when it is ready.
+        :param port_width: Width of rx_port in bits. Unused bits are held high.
+        :param lines:      List of (bit, baud, data) for each line driven.
+        """
+        self._rx_port = rx_port
+        self._tx_port = tx_port
+        self._port_width = port_width
+        self._lines = lines
+
+    def get_edges(self):
+        """
+        Returns a sorted list of (time in ps, bit, value) for all lines.
+        """
+        edges = []
+        for bit, baud, data in self._lines:
+            bit_time = 1e12 / baud
+            t = 0
+            for byte in data:
+                for val in [0] + [(byte >> j) & 1 for j in range(8)] + [1]:
+                    edges.append((t, bit, val))
+                    t += bit_time
+        return sorted(edges)
+
+    def run(self):
+        xsi = self.xsi
+        value = (1 << self._port_width) - 1
+        xsi.drive_port_pins(self._rx_port, value)
+
+        self.wait((lambda _x: self.xsi.is_port_driving(self._tx_port)))
+
+        start_time = xsi.get_time()
+        for t, bit, val in self.get_edges():
+            self.wait_until(start_time + t)
+            value = (value & ~(1 << bit)) | (val << bit)
+            xsi.drive_port_pins(self._rx_port, value)
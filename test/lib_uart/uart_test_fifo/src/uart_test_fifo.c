@@ -179,6 +179,218 @@ void test_empty(uart_buffer_t *buff){
     }
 }
 
+#define RING_ALLOC      (BUFFER_SIZE + 1)
+#define RING_CAPACITY   64 //Largest power of 2 that fits in RING_ALLOC
+
+void test_bulk(uart_ring_t *ring){
+    uint8_t src[RING_CAPACITY + 5];
+    uint8_t dst[RING_CAPACITY + 5];
+    for(int i = 0; i < sizeof(src); i++){
+        src[i] = i + 1;
+    }
+
+    //drain
+    uint8_t data = 0;
+    while(uart_ring_pop_byte(ring, &data) == UART_BUFFER_OK);
+
+    //Offset the indices so the block copies have to wrap
+    for(int offset = 0; offset < RING_CAPACITY; offset += 13){
+        for(int i = 0; i < offset; i++){
+            uart_ring_push_byte(ring, 0);
+            uart_ring_pop_byte(ring, &data);
+        }
+
+        size_t pushed = uart_ring_push(ring, src, sizeof(src));
+        if(pushed != RING_CAPACITY || uart_ring_fill_level(ring) != RING_CAPACITY){
+            printf("ERROR: bulk push wrong count, expected: %d got: %d\n", RING_CAPACITY, pushed);
+            xassert(0);
+        }
+        if(uart_ring_push(ring, src, 1) != 0){
+            printf("ERROR: bulk push into full FIFO\n");
+            xassert(0);
+        }
+
+        size_t popped = uart_ring_pop(ring, dst, 10);
+        popped += uart_ring_pop(ring, &dst[10], sizeof(dst) - 10);
+        if(popped != RING_CAPACITY || uart_ring_fill_level(ring) != 0){
+            printf("ERROR: bulk pop wrong count, expected: %d got: %d\n", RING_CAPACITY, popped);
+            xassert(0);
+        }
+        for(int i = 0; i < RING_CAPACITY; i++){
+            if(dst[i] != src[i]){
+                printf("ERROR: wrong data at %d expected: %d got: %d\n", i, src[i], dst[i]);
+                xassert(0);
+            }
+        }
+    }
+
+    printf("test_bulk: PASS\n");
+}
+
+void test_ring_capacity(uart_ring_t *ring){
+    uint8_t data = 0;
+    xassert(uart_ring_fill_level(ring) == 0);
+    xassert(uart_ring_pop_byte(ring, &data) == UART_BUFFER_EMPTY);
+
+    for(int i = 0; i < RING_CAPACITY; i++){
+        xassert(uart_ring_push_byte(ring, i) == UART_BUFFER_OK);
+    }
+    if(uart_ring_push_byte(ring, 0) != UART_BUFFER_FULL || uart_ring_fill_level(ring) != RING_CAPACITY){
+        printf("ERROR: ring capacity wrong, expected: %d got: %d\n", RING_CAPACITY, uart_ring_fill_level(ring));
+        xassert(0);
+    }
+    for(int i = 0; i < RING_CAPACITY; i++){
+        xassert(uart_ring_pop_byte(ring, &data) == UART_BUFFER_OK);
+        if(data != i){
+            printf("ERROR: wrong data expected: %d got: %d\n", i, data);
+            xassert(0);
+        }
+    }
+    xassert(uart_ring_pop_byte(ring, &data) == UART_BUFFER_EMPTY);
+
+    printf("test_ring_capacity: PASS\n");
+}
+
+void test_ring_in_place(uart_ring_t *ring){
+    //Start just short of where the free running indices overflow
+    ring->write_idx = ring->read_idx = 0xffffffff - 20;
+    uint8_t expect = 0;
+    uint8_t next = 0;
+
+    for(int round = 0; round < 10; round++){
+        //Producer fills in place, which takes two goes when it wraps
+        size_t len = 0;
+        size_t total = 0;
+        do {
+            uint8_t *dst = uart_ring_reserve(ring, RING_CAPACITY, &len);
+            for(int i = 0; i < len; i++){
+                dst[i] = next++;
+            }
+            uart_ring_commit(ring, len);
+            total += len;
+        } while(len);
+        if(total != RING_CAPACITY || uart_ring_fill_level(ring) != RING_CAPACITY){
+            printf("ERROR: ring reserve wrong count, expected: %d got: %d\n", RING_CAPACITY, total);
+            xassert(0);
+        }
+
+        //Consumer reads in place in odd sized pieces
+        total = 0;
+        do {
+            const uint8_t *src = uart_ring_peek(ring, 7, &len);
+            for(int i = 0; i < len; i++){
+                if(src[i] != expect){
+                    printf("ERROR: wrong data expected: %d got: %d\n", expect, src[i]);
+                    xassert(0);
+                }
+                expect++;
+            }
+            uart_ring_release(ring, len);
+            total += len;
+        } while(len);
+        xassert(total == RING_CAPACITY && uart_ring_fill_level(ring) == 0);
+    }
+
+    printf("test_ring_in_place: PASS\n");
+}
+
+//Pushes an encoded stream and checks the results and the last packet
+static void deframe_check(uart_deframer_t *d, const uint8_t *enc, size_t n, const uart_deframe_result_t *expect,
+                          const uint8_t *packet, size_t len){
+    for(int i = 0; i < n; i++){
+        uart_deframe_result_t res = uart_deframer_push(d, enc[i]);
+        if(res != expect[i]){
+            printf("ERROR: deframer byte %d expected: %d got: %d\n", i, expect[i], res);
+            xassert(0);
+        }
+    }
+    xassert(d->len == len);
+    for(int i = 0; i < len; i++){
+        xassert(d->packet[i] == packet[i]);
+    }
+}
+
+void test_deframer(void){
+    const uart_deframe_result_t M = UART_DEFRAME_MORE, P = UART_DEFRAME_PACKET, E = UART_DEFRAME_ERROR;
+    uint8_t packet[4];
+    uart_deframer_t d;
+
+    //SLIP with both escapes and a leading END
+    uart_deframer_init(&d, UART_FRAMING_SLIP, packet, sizeof(packet));
+    const uint8_t slip[] = {0xC0, 0x01, 0xDB, 0xDC, 0xDB, 0xDD, 0xC0};
+    const uart_deframe_result_t slip_res[] = {M, M, M, M, M, M, P};
+    const uint8_t slip_dec[] = {0x01, 0xC0, 0xDB};
+    deframe_check(&d, slip, sizeof(slip), slip_res, slip_dec, sizeof(slip_dec));
+
+    //SLIP too long, then a bad escape, then recovery
+    const uint8_t slip_bad[] = {1, 2, 3, 4, 5, 6, 0xC0, 0xDB, 0x00, 7, 0xC0, 8, 0xC0};
+    const uart_deframe_result_t slip_bad_res[] = {M, M, M, M, E, M, M, M, E, M, M, M, P};
+    const uint8_t slip_bad_dec[] = {8};
+    deframe_check(&d, slip_bad, sizeof(slip_bad), slip_bad_res, slip_bad_dec, sizeof(slip_bad_dec));
+
+    //COBS of {0x11, 0x00, 0x00, 0x22} then {0x00}
+    uart_deframer_init(&d, UART_FRAMING_COBS, packet, sizeof(packet));
+    const uint8_t cobs[] = {0x02, 0x11, 0x01, 0x02, 0x22, 0x00};
+    const uart_deframe_result_t cobs_res[] = {M, M, M, M, M, P};
+    const uint8_t cobs_dec[] = {0x11, 0x00, 0x00, 0x22};
+    deframe_check(&d, cobs, sizeof(cobs), cobs_res, cobs_dec, sizeof(cobs_dec));
+    const uint8_t cobs_zero[] = {0x01, 0x01, 0x00};
+    const uart_deframe_result_t cobs_zero_res[] = {M, M, P};
+    const uint8_t cobs_zero_dec[] = {0x00};
+    deframe_check(&d, cobs_zero, sizeof(cobs_zero), cobs_zero_res, cobs_zero_dec, sizeof(cobs_zero_dec));
+
+    //COBS truncated block is an error, then recovery
+    const uint8_t cobs_bad[] = {0x04, 0x33, 0x00, 0x02, 0x44, 0x00};
+    const uart_deframe_result_t cobs_bad_res[] = {M, M, E, M, M, P};
+    const uint8_t cobs_bad_dec[] = {0x44};
+    deframe_check(&d, cobs_bad, sizeof(cobs_bad), cobs_bad_res, cobs_bad_dec, sizeof(cobs_bad_dec));
+
+    printf("test_deframer: PASS\n");
+}
+
+void test_crc(void){
+    //Check values of the presets and some catalogue CRCs over "123456789"
+    const uint8_t msg[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    const uint32_t preset_check[] = {0xF4, 0x29B1, 0x4B37, 0xCBF43926};
+    uart_crc_t crc;
+
+    for(int p = UART_CRC_8; p <= UART_CRC_32; p++){
+        uart_crc_init_preset(&crc, p);
+        for(int i = 0; i < sizeof(msg); i++){
+            uart_crc_update(&crc, msg[i]);
+        }
+        uint32_t check = uart_crc_result(&crc);
+        if(check != preset_check[p]){
+            printf("ERROR: crc preset %d expected: 0x%x got: 0x%x\n", p, (unsigned)preset_check[p], (unsigned)check);
+            xassert(0);
+        }
+
+        //The message followed by its CRC leaves the residue
+        uint8_t bytes[4];
+        size_t n = uart_crc_get_bytes(&crc, bytes);
+        xassert(n == crc.width / 8);
+        for(int i = 0; i < n; i++){
+            uart_crc_update(&crc, bytes[i]);
+        }
+        xassert(uart_crc_result(&crc) == uart_crc_residue(&crc));
+        uart_crc_reset(&crc);
+    }
+    xassert(uart_crc_residue(&crc) == 0x2144DF1C); //CRC-32
+
+    uart_crc_init(&crc, 16, 0x1021, 0x0000, 0x0000, 0); //CRC-16/XMODEM
+    for(int i = 0; i < sizeof(msg); i++){
+        uart_crc_update(&crc, msg[i]);
+    }
+    xassert(uart_crc_result(&crc) == 0x31C3);
+    uart_crc_init(&crc, 8, 0x31, 0x00, 0x00, 1); //CRC-8/MAXIM
+    for(int i = 0; i < sizeof(msg); i++){
+        uart_crc_update(&crc, msg[i]);
+    }
+    xassert(uart_crc_result(&crc) == 0xA1);
+
+    printf("test_crc: PASS\n");
+}
+
 void test() {
     uart_buffer_t buff;
     uint8_t storage[BUFFER_ALLOC];
@@ -188,6 +400,15 @@ void test() {
     test_fill_level(&buff);
     test_full(&buff);
     test_empty(&buff);
+
+    uart_ring_t ring;
+    uint8_t ring_storage[RING_ALLOC];
+    uart_ring_init(&ring, ring_storage, RING_ALLOC);
+    test_ring_capacity(&ring);
+    test_ring_in_place(&ring);
+    test_bulk(&ring);
+    test_deframer();
+    test_crc();
     
     exit(0);
 }
@@ -0,0 +1,75 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/parallel.h>
+#include <xcore/port.h>
+
+#include "uart.h"
+
+//The checker loops the Tx pin back to the Rx pin and measures the bit rate of the first burst
+#define BURST_LEN       64
+
+port_t p_uart_tx = XS1_PORT_1A;
+port_t p_uart_rx = XS1_PORT_1B;
+xclock_t clk_uart = XS1_CLKBLK_1;
+
+DECLARE_JOB(run_uart_hs, (uart_hs_t *));
+
+void run_uart_hs(uart_hs_t *ctx){
+    uart_hs(ctx);
+}
+
+static int loopback_burst(uart_hs_t *ctx, const uint8_t *data){
+    uint8_t received[BURST_LEN];
+    size_t sent = 0, got = 0;
+    while(got < BURST_LEN){
+        if(sent < BURST_LEN){
+            sent += uart_hs_write(ctx, data + sent, BURST_LEN - sent);
+        }
+        got += uart_hs_read(ctx, received + got, BURST_LEN - got);
+    }
+    for(int i = 0; i < BURST_LEN; i++){
+        if(received[i] != data[i]){
+            return 0;
+        }
+    }
+    return 1;
+}
+
+DECLARE_JOB(test, (uart_hs_t *));
+
+void test(uart_hs_t *ctx){
+    uint8_t data[BURST_LEN];
+
+    //0x55 toggles the line every bit, so the checker sees each bit time
+    for(int i = 0; i < BURST_LEN; i++){
+        data[i] = 0x55;
+    }
+    int rate_burst_ok = loopback_burst(ctx, data);
+
+    for(int i = 0; i < BURST_LEN; i++){
+        data[i] = i * 37;
+    }
+    int data_burst_ok = loopback_burst(ctx, data);
+
+    printf("data ok: %s\n", (rate_burst_ok && data_burst_ok) ? "True" : "False");
+    exit(0);
+}
+
+//Only two threads so the uart_hs() thread gets the core speed it needs at 12.5 Mbaud
+int main(void) {
+    uart_hs_t ctx;
+    uint8_t tx_buffer[BURST_LEN * 2 + 1];
+    uint8_t rx_buffer[BURST_LEN * 2 + 1];
+
+    uart_hs_init(&ctx, p_uart_tx, p_uart_rx, clk_uart, TEST_BAUD, 8, UART_PARITY_NONE, 1,
+                 tx_buffer, sizeof(tx_buffer), rx_buffer, sizeof(rx_buffer), NULL, NULL, NULL);
+
+    PAR_JOBS (
+        PJOB(run_uart_hs, (&ctx)),
+        PJOB(test, (&ctx))
+    );
+    return 0;
+}
@@ -0,0 +1,49 @@
+#**********************
+# Gather Sources
+#**********************
+# The legacy XC loopback test in src/uart_test.xc is not built
+set(APP_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/hs_loopback.c)
+set(APP_INCLUDES ${CMAKE_CURRENT_LIST_DIR}/src ${CMAKE_CURRENT_LIST_DIR}/..)
+
+#**********************
+# Flags
+#**********************
+set(APP_COMPILER_FLAGS
+    -Os
+    -target=XCORE-AI-EXPLORER
+)
+set(APP_LINK_OPTIONS
+    -report
+    -target=XCORE-AI-EXPLORER
+)
+
+#**********************
+# Tile Targets
+#**********************
+# 12.5MHz / n for n = 1, 2 and 4
+if(NOT DEFINED ENV{TEST_HS_BAUD})
+    set(TEST_HS_BAUD 12500000 6250000 3125000)
+else()
+    set(TEST_HS_BAUD $ENV{TEST_HS_BAUD})
+endif()
+
+
+#**********************
+# Setup targets
+#**********************
+foreach(baud ${TEST_HS_BAUD})
+    set(TARGET_NAME "test_hil_uart_loopback_test_hs_${baud}")
+    add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL)
+    target_sources(${TARGET_NAME} PUBLIC ${APP_SOURCES})
+    target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+    target_compile_definitions(${TARGET_NAME}
+        PRIVATE
+            ${APP_COMPILE_DEFINITIONS}
+            TEST_BAUD=${baud}
+    )
+    target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+    target_link_libraries(${TARGET_NAME} PUBLIC lib_uart framework_core_utils)
+    target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
+    set_target_properties(${TARGET_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/bin)
+    unset(TARGET_NAME)
+endforeach()
@@ -0,0 +1,42 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Starts at the wrong rate and must lock on to the 0x55 preamble sent by the checker
+#define INITIAL_BAUD    9600
+#define NUM_RX_WORDS    4
+
+volatile uint32_t detected_baud = 0;
+
+HIL_UART_RX_CALLBACK_ATTR void autobaud_callback(uint32_t baud_rate, void *app_data){
+    detected_baud = baud_rate;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1];
+
+    uart_rx_init(   &uart, p_uart_rx, INITIAL_BAUD, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_autobaud(&uart, UART_AUTOBAUD_SNAP, autobaud_callback);
+
+    while(bytes_received < NUM_RX_WORDS && !test_abort);
+
+    printf("baud: %u\n", (unsigned)detected_baud);
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%02x\n", uart_rx(&uart));
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
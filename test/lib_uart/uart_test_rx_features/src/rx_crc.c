@@ -0,0 +1,51 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Two Modbus RTU packets ending in their CRC, the second corrupted. Each ends at the idle timeout
+#define NUM_PACKETS     2
+#define IDLE_BITS       20
+
+volatile unsigned packets_received = 0;
+volatile size_t packet_len[NUM_PACKETS];
+volatile uint32_t packet_crc[NUM_PACKETS];
+
+HIL_UART_RX_CALLBACK_ATTR void idle_callback(size_t num_bytes, void *app_data){
+    uart_rx_t *uart = (uart_rx_t *)app_data;
+    if(packets_received < NUM_PACKETS){
+        packet_len[packets_received] = num_bytes;
+        packet_crc[packets_received] = uart_rx_get_packet_crc(uart);
+        packets_received += 1;
+    }
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1];
+    uart_crc_t crc;
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_crc_init_preset(&crc, UART_CRC_16_MODBUS);
+    uart_rx_set_crc(&uart, &crc);
+    uart_rx_set_idle_timeout(&uart, IDLE_BITS, idle_callback);
+
+    while(packets_received < NUM_PACKETS && !test_abort);
+
+    for(int i = 0; i < NUM_PACKETS; i++){
+        printf("packet %d: %u bytes crc 0x%04x\n", i, (unsigned)packet_len[i], (unsigned)packet_crc[i]);
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
@@ -0,0 +1,61 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "uart_define.h"
+#include "rx_features_common.h"
+
+//The same bytes arrive on both UARTs at once so their ISRs see the same load
+#define NUM_RX_WORDS    4
+
+port_t p_uart_rx_define = XS1_PORT_1C;
+
+volatile unsigned define_bytes_received = 0;
+
+UART_RX_DEFINE(uart_rx_8n1, 8, NONE, 1, BUFFERED)
+
+HIL_UART_RX_CALLBACK_ATTR void define_complete_callback(void *app_data){
+    define_bytes_received += 1;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart, uart_define;
+    hwtimer_t tmr = hwtimer_alloc();
+    hwtimer_t tmr_define = hwtimer_alloc();
+    uint8_t buffer[64 + 1];
+    uint8_t buffer_define[64 + 1];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_8n1_init(&uart_define, p_uart_rx_define, 115200, tmr_define,
+                    buffer_define, sizeof(buffer_define), define_complete_callback, rx_error_callback, &uart_define);
+
+    while((bytes_received < NUM_RX_WORDS || define_bytes_received < NUM_RX_WORDS) && !test_abort);
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        uint8_t generic = uart_rx(&uart);
+        uint8_t define = uart_rx_8n1_rx(&uart_define);
+        printf("0x%02x 0x%02x\n", generic, define);
+    }
+
+    uart_stats_t stats, stats_define;
+    uart_rx_get_stats(&uart, &stats);
+    uart_rx_get_stats(&uart_define, &stats_define);
+    printf("Interesting stats: generic ISR max %u mean %u ticks, specialised ISR max %u mean %u ticks\n",
+            (unsigned)stats.isr_ticks_max, (unsigned)stats.isr_ticks_mean,
+            (unsigned)stats_define.isr_ticks_max, (unsigned)stats_define.isr_ticks_mean);
+    printf("specialised ISR not longer: %s\n",
+            (stats_define.isr_count && stats_define.isr_ticks_max <= stats.isr_ticks_max) ? "True" : "False");
+
+    uart_rx_deinit(&uart);
+    uart_rx_deinit(&uart_define);
+    hwtimer_free(tmr);
+    hwtimer_free(tmr_define);
+
+    exit(0);
+}
@@ -0,0 +1,71 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/triggerable.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//One thread waits on two UARTs at different rates and a periodic timer together
+#define NUM_RX_WORDS    4
+#define TIMER_PERIOD    10000 //100us
+
+port_t p_uart_rx_b = XS1_PORT_1C;
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart_a, uart_b;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t data_a[NUM_RX_WORDS];
+    uint8_t data_b[NUM_RX_WORDS];
+    unsigned num_a = 0, num_b = 0, timer_events = 0;
+
+    uart_rx_event_init(&uart_a, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, rx_error_callback, &uart_a);
+    uart_rx_event_init(&uart_b, p_uart_rx_b, 57600, 8, UART_PARITY_NONE, 1, rx_error_callback, &uart_b);
+
+    triggerable_disable_all();
+    TRIGGERABLE_SETUP_EVENT_VECTOR(p_uart_rx, event_uart_a);
+    TRIGGERABLE_SETUP_EVENT_VECTOR(p_uart_rx_b, event_uart_b);
+    TRIGGERABLE_SETUP_EVENT_VECTOR(tmr, event_timer);
+    hwtimer_set_trigger_time(tmr, hwtimer_get_time(tmr) + TIMER_PERIOD);
+    triggerable_enable_trigger(p_uart_rx);
+    triggerable_enable_trigger(p_uart_rx_b);
+    triggerable_enable_trigger(tmr);
+
+    while(num_a < NUM_RX_WORDS || num_b < NUM_RX_WORDS){
+        uint8_t rx_data;
+        TRIGGERABLE_WAIT_EVENT(event_uart_a, event_uart_b, event_timer);
+        event_uart_a:
+            if(uart_rx_service_event(&uart_a, &rx_data) && num_a < NUM_RX_WORDS){
+                data_a[num_a++] = rx_data;
+            }
+            continue;
+        event_uart_b:
+            if(uart_rx_service_event(&uart_b, &rx_data) && num_b < NUM_RX_WORDS){
+                data_b[num_b++] = rx_data;
+            }
+            continue;
+        event_timer:
+            hwtimer_change_trigger_time(tmr, hwtimer_get_time(tmr) + TIMER_PERIOD);
+            timer_events += 1;
+            continue;
+    }
+    triggerable_disable_all();
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("a: 0x%02x\n", data_a[i]);
+    }
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("b: 0x%02x\n", data_b[i]);
+    }
+    printf("timer serviced: %s\n", timer_events ? "True" : "False");
+
+    uart_rx_deinit(&uart_a);
+    uart_rx_deinit(&uart_b);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
@@ -0,0 +1,97 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <print.h>
+#include <stdlib.h>
+#include <xcore/parallel.h>
+#include <xcore/port.h>
+#include <xcore/hwtimer.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+port_t p_uart_tx = XS1_PORT_1A;
+port_t p_uart_rx = XS1_PORT_1B;
+
+volatile unsigned bytes_received = 0;
+volatile unsigned test_abort = 0;
+
+HIL_UART_RX_CALLBACK_ATTR void rx_error_callback(uart_callback_code_t callback_code, void *app_data){
+
+    switch(callback_code){
+        case UART_START_BIT_ERROR:
+            printstrln("UART_START_BIT_ERROR");
+            break;
+        case UART_PARITY_ERROR:
+            printstrln("UART_PARITY_ERROR");
+            break;
+        case UART_FRAMING_ERROR:
+            printstrln("UART_FRAMING_ERROR");
+            test_abort = 1;
+            break;
+        case UART_OVERRUN_ERROR:
+            printstrln("UART_OVERRUN_ERROR");
+            break;
+        case UART_UNDERRUN_ERROR:
+            printstrln("UART_UNDERRUN_ERROR");
+            break;
+        case UART_PACKET_ERROR:
+            printstrln("UART_PACKET_ERROR");
+            break;
+        case UART_NOISE_ERROR:
+            printstrln("UART_NOISE_ERROR");
+            break;
+        default:
+            printstr("Unexpected callback code: ");
+            printintln(callback_code);
+    }
+}
+
+HIL_UART_RX_CALLBACK_ATTR void rx_complete_callback(void *app_data){
+    uart_rx_t *uart = (uart_rx_t *)app_data;
+    uart_callback_code_t callback_info = uart->cb_code;
+
+    switch(callback_info){
+        case UART_RX_COMPLETE:
+            bytes_received += 1;
+            break;
+
+        default:
+            printstr("Unexpected callback code: ");
+            printintln(callback_info);
+    }
+}
+
+DECLARE_JOB(burn, (void));
+
+void burn(void) {
+    for(;;);
+}
+
+DECLARE_JOB(start_sim, (void));
+void start_sim(void){
+    hwtimer_t tmr = hwtimer_alloc();
+    uint32_t time = hwtimer_get_time(tmr);
+    hwtimer_wait_until(tmr, time + 200); //2us - enough to allow the test to set up the UART
+    port_enable(p_uart_tx);
+    port_out(p_uart_tx, 0);
+    //Tester will now transmit the bytes
+    hwtimer_free(tmr);
+    port_disable(p_uart_tx);
+    burn();
+}
+
+//One thread is left for tests that run jobs of their own
+int main(void) {
+    PAR_JOBS (
+        PJOB(INTERRUPT_PERMITTED(test), ()),
+        PJOB(start_sim, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ())
+    );
+    return 0;
+}
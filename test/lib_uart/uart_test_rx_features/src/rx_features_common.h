@@ -0,0 +1,20 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#pragma once
+
+#include <xcore/port.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+
+extern port_t p_uart_tx; //Driven low by start_sim() to start the checker
+extern port_t p_uart_rx;
+
+extern volatile unsigned bytes_received;
+extern volatile unsigned test_abort;
+
+HIL_UART_RX_CALLBACK_ATTR void rx_error_callback(uart_callback_code_t callback_code, void *app_data);
+HIL_UART_RX_CALLBACK_ATTR void rx_complete_callback(void *app_data);
+
+//Defined by each feature test
+DECLARE_INTERRUPT_PERMITTED(void, test, void);
@@ -0,0 +1,51 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Three packets separated by more than the idle timeout. The second has a gap
+//shorter than the timeout in it which must not end the packet
+#define NUM_PACKETS     3
+#define IDLE_BITS       10
+
+volatile unsigned packets_received = 0;
+volatile size_t packet_len[NUM_PACKETS];
+
+HIL_UART_RX_CALLBACK_ATTR void idle_callback(size_t num_bytes, void *app_data){
+    if(packets_received < NUM_PACKETS){
+        packet_len[packets_received] = num_bytes;
+        packets_received += 1;
+    }
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1];
+
+    //No complete callback, the consumer is only woken per packet
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), NULL, rx_error_callback, &uart);
+    uart_rx_set_idle_timeout(&uart, IDLE_BITS, idle_callback);
+
+    while(packets_received < NUM_PACKETS && !test_abort);
+
+    for(int i = 0; i < NUM_PACKETS; i++){
+        printf("packet %d: %u bytes", i, (unsigned)packet_len[i]);
+        for(int j = 0; j < packet_len[i]; j++){
+            printf(" 0x%02x", uart_rx(&uart));
+        }
+        printf("\n");
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
@@ -0,0 +1,37 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//The checker puts a 1us glitch in the middle of some bits. With samples 2us
+//apart only the middle one sees it, so the words are received intact and the
+//glitched frames are reported as noise
+#define NUM_RX_WORDS    4
+#define VOTE_TICKS      200
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[16 + 1];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_majority_vote(&uart, VOTE_TICKS);
+
+    while(bytes_received < NUM_RX_WORDS && !test_abort);
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%02x\n", uart_rx(&uart));
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
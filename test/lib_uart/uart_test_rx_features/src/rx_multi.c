@@ -0,0 +1,64 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/clock.h>
+#include <xcore/parallel.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Three lines at different rates on one 4b port, bit 2 is left unused
+#define NUM_LINES       3
+#define NUM_RX_WORDS    4
+#define SAMPLE_RATE     1000000
+
+port_t p_uart_rx_multi = XS1_PORT_4A;
+xclock_t clk_uart_rx_multi = XS1_CLKBLK_1;
+
+static const unsigned lines[NUM_LINES] = {0, 1, 3};
+static const uint32_t bauds[NUM_LINES] = {115200, 57600, 38400};
+
+volatile unsigned line_bytes_received[UART_RX_MULTI_MAX_LINES] = {0};
+
+HIL_UART_RX_CALLBACK_ATTR void rx_multi_complete_callback(void *app_data){
+    *(volatile unsigned *)app_data += 1;
+}
+
+DECLARE_JOB(uart_rx_multi, (uart_rx_multi_t *));
+DECLARE_JOB(reader, (uart_rx_multi_t *));
+
+void reader(uart_rx_multi_t *ctx){
+    for(int i = 0; i < NUM_LINES; i++){
+        while(line_bytes_received[lines[i]] < NUM_RX_WORDS && !test_abort);
+    }
+
+    for(int i = 0; i < NUM_LINES; i++){
+        for(int j = 0; j < NUM_RX_WORDS; j++){
+            uint8_t data = 0;
+            uart_buffer_error_t err = uart_rx_multi_read(ctx, lines[i], &data);
+            printf("line %u: 0x%02x%s\n", lines[i], data, err == UART_BUFFER_OK ? "" : " empty");
+        }
+    }
+
+    exit(0);
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_multi_t ctx;
+    uint8_t buffers[NUM_LINES][16 + 1];
+
+    uart_rx_multi_init(&ctx, p_uart_rx_multi, 4, clk_uart_rx_multi, SAMPLE_RATE);
+    for(int i = 0; i < NUM_LINES; i++){
+        uart_rx_multi_line_init(&ctx, lines[i], bauds[i], 8, UART_PARITY_NONE, 1,
+                        buffers[i], sizeof(buffers[i]), rx_multi_complete_callback, rx_error_callback,
+                        (void *)&line_bytes_received[lines[i]]);
+    }
+
+    PAR_JOBS (
+        PJOB(uart_rx_multi, (&ctx)),
+        PJOB(reader, (&ctx))
+    );
+}
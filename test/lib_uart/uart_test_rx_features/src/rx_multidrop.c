@@ -0,0 +1,37 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//The checker addresses nodes 1, 2 then 1 again. Only frames for node 1 are kept
+#define NODE_ADDRESS    0x01
+#define NUM_RX_WORDS    5
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1];
+    uint8_t marks[sizeof(buffer)];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_multidrop(&uart, NODE_ADDRESS, 0xff, marks, sizeof(marks));
+
+    while(bytes_received < NUM_RX_WORDS && !test_abort);
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%03x\n", uart_rx_multidrop(&uart));
+    }
+    printf("received: %u\n", bytes_received); //None for node 2
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
@@ -0,0 +1,49 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/clock.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//8x at 921600, where the sample clock of 50MHz / 6 gives 9.04 samples per bit,
+//and 16x at 115200 on a second port
+#define NUM_RX_WORDS    4
+
+port_t p_uart_rx_16x = XS1_PORT_1C;
+xclock_t clk_uart_rx = XS1_CLKBLK_1;
+xclock_t clk_uart_rx_16x = XS1_CLKBLK_2;
+
+volatile unsigned bytes_received_16x = 0;
+
+HIL_UART_RX_CALLBACK_ATTR void rx_complete_callback_16x(void *app_data){
+    bytes_received_16x += 1;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart, uart_16x;
+    uint8_t buffer[64 + 1];
+    uint8_t buffer_16x[64 + 1];
+
+    uart_rx_oversampled_init(&uart, p_uart_rx, clk_uart_rx, 921600, 8, 8, UART_PARITY_NONE, 1,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_oversampled_init(&uart_16x, p_uart_rx_16x, clk_uart_rx_16x, 115200, 16, 8, UART_PARITY_NONE, 1,
+                    buffer_16x, sizeof(buffer_16x), rx_complete_callback_16x, rx_error_callback, &uart_16x);
+
+    while((bytes_received < NUM_RX_WORDS || bytes_received_16x < NUM_RX_WORDS) && !test_abort);
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%02x\n", uart_rx(&uart));
+    }
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("16x 0x%02x\n", uart_rx(&uart_16x));
+    }
+
+    uart_rx_deinit(&uart);
+    uart_rx_deinit(&uart_16x);
+
+    exit(0);
+}
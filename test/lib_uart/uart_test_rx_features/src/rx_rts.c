@@ -0,0 +1,51 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//RTS is deasserted at the high watermark so the checker stops sending until
+//the buffer has been read back down to the low watermark
+#define RTS_HIGH_WATERMARK  4
+#define RTS_LOW_WATERMARK   1
+#define NUM_RX_WORDS        8
+#define HOLD_TICKS          50000 //500us, several frames at 115200
+
+port_t p_uart_rts = XS1_PORT_1C;
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    hwtimer_t tmr_hold = hwtimer_alloc();
+    uint8_t buffer[16 + 1];
+    uint8_t data[NUM_RX_WORDS];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_rts(&uart, p_uart_rts, RTS_HIGH_WATERMARK, RTS_LOW_WATERMARK);
+
+    //Hold off reading so nothing more arrives once RTS is deasserted
+    while(bytes_received < RTS_HIGH_WATERMARK && !test_abort);
+    hwtimer_wait_until(tmr_hold, hwtimer_get_time(tmr_hold) + HOLD_TICKS);
+    printf("received while RTS deasserted: %u\n", bytes_received);
+
+    //Reading reasserts RTS at the low watermark, so the rest then arrive
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        while(bytes_received <= i && !test_abort);
+        data[i] = uart_rx(&uart);
+    }
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%02x\n", data[i]);
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+    hwtimer_free(tmr_hold);
+
+    exit(0);
+}
@@ -0,0 +1,81 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Six words into a four word buffer overrun twice, and reading five underruns once.
+//A buffered Tx on a spare port checks the Tx side counts too
+#define NUM_RX_WORDS    6
+#define NUM_READS       5
+#define NUM_TX_WORDS    3
+
+port_t p_uart_tx_stats = XS1_PORT_1D;
+
+volatile unsigned frames_received = 0;
+volatile unsigned tx_stats_empty = 0;
+
+//Counts overrun words too, where cb_code is the error
+HIL_UART_RX_CALLBACK_ATTR void rx_stats_callback(void *app_data){
+    frames_received += 1;
+}
+
+HIL_UART_TX_CALLBACK_ATTR void tx_stats_callback(void *app_data){
+    tx_stats_empty = 1;
+}
+
+static int isr_timed(const uart_stats_t *stats){
+    return stats->isr_count > 0 && stats->isr_ticks_min <= stats->isr_ticks_mean &&
+           stats->isr_ticks_mean <= stats->isr_ticks_max;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    uart_tx_t uart_stats_tx;
+    hwtimer_t tmr = hwtimer_alloc();
+    hwtimer_t tmr_tx = hwtimer_alloc();
+    uint8_t buffer[4 + 1];
+    uint8_t buffer_tx[16 + 1];
+    uart_stats_t stats;
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_stats_callback, rx_error_callback, &uart);
+
+    while(frames_received < NUM_RX_WORDS && !test_abort);
+    for(int i = 0; i < NUM_READS; i++){
+        uart_rx(&uart);
+    }
+
+    uart_rx_get_stats(&uart, &stats);
+    printf("Interesting stats: rx ISR min %u mean %u max %u ticks\n",
+            (unsigned)stats.isr_ticks_min, (unsigned)stats.isr_ticks_mean, (unsigned)stats.isr_ticks_max);
+    printf("rx frames: %u overruns: %u underruns: %u framing errors: %u high water: %u\n",
+            (unsigned)stats.frames, (unsigned)stats.overruns, (unsigned)stats.underruns,
+            (unsigned)stats.framing_errors, (unsigned)stats.buffer_high_water);
+    printf("rx ISR timed: %s\n", isr_timed(&stats) ? "True" : "False");
+    uart_rx_reset_stats(&uart);
+    uart_rx_get_stats(&uart, &stats);
+    printf("rx frames after reset: %u\n", (unsigned)stats.frames);
+
+    uart_tx_init(&uart_stats_tx, p_uart_tx_stats, 115200, 8, UART_PARITY_NONE, 1, tmr_tx,
+                    buffer_tx, sizeof(buffer_tx), tx_stats_callback, &uart_stats_tx);
+    for(int i = 0; i < NUM_TX_WORDS; i++){
+        uart_tx(&uart_stats_tx, i);
+    }
+    while(!tx_stats_empty);
+    uart_tx_get_stats(&uart_stats_tx, &stats);
+    printf("tx frames: %u\n", (unsigned)stats.frames);
+    printf("tx ISR timed: %s\n", isr_timed(&stats) ? "True" : "False");
+
+    uart_rx_deinit(&uart);
+    uart_tx_deinit(&uart_stats_tx);
+    hwtimer_free(tmr);
+    hwtimer_free(tmr_tx);
+
+    exit(0);
+}
@@ -0,0 +1,75 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/channel_streaming.h>
+#include <xcore/parallel.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//Two bursts ended by the idle timeout. The first ends part way through a
+//word so it ends in 2 bytes, and the second on a whole word so it ends in 0
+#define NUM_BURSTS      2
+#define MAX_READS       8
+#define IDLE_BITS       10
+
+typedef struct {
+    size_t n;
+    uint8_t data[4];
+} stream_read_t;
+
+stream_read_t reads[MAX_READS];
+volatile unsigned num_reads = 0;
+volatile unsigned stream_done = 0;
+
+DECLARE_JOB(isr_host, (void));
+DECLARE_JOB(consumer, (chanend_t));
+
+void isr_host(void){
+    while(!stream_done); //Leaves this thread to the Rx ISR
+}
+
+void consumer(chanend_t c){
+    unsigned bursts = 0;
+    while(bursts < NUM_BURSTS && num_reads < MAX_READS){
+        stream_read_t *r = &reads[num_reads];
+        r->n = uart_rx_stream_in(c, r->data);
+        bursts += r->n < 4;
+        num_reads += 1;
+    }
+    stream_done = 1;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[16 + 1];
+    streaming_channel_t c = s_chan_alloc();
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), NULL, rx_error_callback, &uart);
+    uart_rx_set_streaming(&uart, c.end_a);
+    uart_rx_set_idle_timeout(&uart, IDLE_BITS, NULL); //No callback needed once streaming
+
+    PAR_JOBS(
+        PJOB(isr_host, ()),
+        PJOB(consumer, (c.end_b))
+    );
+
+    for(int i = 0; i < num_reads; i++){
+        printf("%u bytes:", (unsigned)reads[i].n);
+        for(int j = 0; j < reads[i].n; j++){
+            printf(" 0x%02x", reads[i].data[j]);
+        }
+        printf("\n");
+    }
+
+    uart_rx_deinit(&uart);
+    s_chan_free(c);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
@@ -0,0 +1,51 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//The checker sends two frames back to back, then idles 100us and 200us before
+//the next two, so the start bits are these many ticks after the one before
+#define NUM_RX_WORDS    4
+#define FRAME_TICKS     8681 //10 bits at 115200
+#define TOLERANCE_TICKS 10
+
+static const uint32_t expected_gap[NUM_RX_WORDS] = {0, FRAME_TICKS, FRAME_TICKS + 10000, FRAME_TICKS + 20000};
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[16 + 1];
+    uint32_t timestamps[16 + 1];
+    uint8_t data[NUM_RX_WORDS];
+    uint32_t time[NUM_RX_WORDS];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_timestamps(&uart, timestamps, sizeof(timestamps) / sizeof(timestamps[0]));
+
+    while(bytes_received < NUM_RX_WORDS && !test_abort);
+
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        data[i] = uart_rx_timestamped(&uart, &time[i]);
+    }
+    for(int i = 0; i < NUM_RX_WORDS; i++){
+        printf("0x%02x\n", data[i]);
+    }
+    for(int i = 1; i < NUM_RX_WORDS; i++){
+        uint32_t gap = time[i] - time[i - 1];
+        printf("Interesting stats: gap %d %u ticks\n", i, (unsigned)gap);
+        printf("gap %d correct: %s\n", i,
+                (gap + TOLERANCE_TICKS >= expected_gap[i] && gap <= expected_gap[i] + TOLERANCE_TICKS) ? "True" : "False");
+    }
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
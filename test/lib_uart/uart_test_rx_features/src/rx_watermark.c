@@ -0,0 +1,55 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "rx_features_common.h"
+
+//The consumer drains two batches of HIGH_WATERMARK words, each when the
+//watermark is reached. The last words do not reach it again
+#define HIGH_WATERMARK  4
+#define NUM_BATCHES     2
+#define NUM_RX_WORDS    (NUM_BATCHES * HIGH_WATERMARK + 2)
+
+volatile unsigned watermark_count = 0;
+
+HIL_UART_RX_CALLBACK_ATTR void high_watermark_callback(void *app_data){
+    watermark_count += 1;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_RX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_rx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[16 + 1];
+    uint8_t batches[NUM_BATCHES][HIGH_WATERMARK];
+
+    uart_rx_init(   &uart, p_uart_rx, 115200, 8, UART_PARITY_NONE, 1, tmr,
+                    buffer, sizeof(buffer), rx_complete_callback, rx_error_callback, &uart);
+    uart_rx_set_high_watermark(&uart, HIGH_WATERMARK, high_watermark_callback);
+
+    for(int i = 0; i < NUM_BATCHES; i++){
+        while(watermark_count <= i && !test_abort);
+        for(int j = 0; j < HIGH_WATERMARK; j++){
+            batches[i][j] = uart_rx(&uart);
+        }
+    }
+    while(bytes_received < NUM_RX_WORDS && !test_abort);
+
+    for(int i = 0; i < NUM_BATCHES; i++){
+        printf("batch %d:", i);
+        for(int j = 0; j < HIGH_WATERMARK; j++){
+            printf(" 0x%02x", batches[i][j]);
+        }
+        printf("\n");
+    }
+    printf("watermark callbacks: %u\n", watermark_count);
+
+    uart_rx_deinit(&uart);
+    hwtimer_free(tmr);
+
+    exit(0);
+}
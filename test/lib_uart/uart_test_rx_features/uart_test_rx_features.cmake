@@ -0,0 +1,80 @@
+#**********************
+# Gather Sources
+#**********************
+# Each feature has its own test() in src/rx_<feature>.c sharing the harness in rx_features_common.c
+set(APP_COMMON_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/rx_features_common.c)
+set(APP_INCLUDES ${CMAKE_CURRENT_LIST_DIR}/src ${CMAKE_CURRENT_LIST_DIR}/..)
+
+#**********************
+# Flags
+#**********************
+set(APP_COMPILER_FLAGS
+    -Os
+    -target=XCORE-AI-EXPLORER
+)
+set(APP_LINK_OPTIONS
+    -report
+    -target=XCORE-AI-EXPLORER
+)
+
+#**********************
+# Tile Targets
+#**********************
+if(NOT DEFINED ENV{TEST_RX_FEATURES})
+    set(TEST_RX_FEATURES autobaud multidrop crc oversampled multi idle_timeout watermark rts event timestamps majority_vote stream)
+else()
+    set(TEST_RX_FEATURES $ENV{TEST_RX_FEATURES})
+endif()
+
+# Features that read the ISR timings, built against lib_uart with UART_STATS_ENABLED
+if(NOT DEFINED ENV{TEST_RX_STATS_FEATURES})
+    set(TEST_RX_STATS_FEATURES define_isr stats)
+else()
+    set(TEST_RX_STATS_FEATURES $ENV{TEST_RX_STATS_FEATURES})
+endif()
+
+#**********************
+# Stats library
+#**********************
+# The context layout depends on UART_STATS_ENABLED so the app and library must agree
+if(NOT TARGET test_lib_uart_stats)
+    get_target_property(LIB_UART_DIR lib_uart SOURCE_DIR)
+    file(GLOB LIB_UART_STATS_SOURCES ${LIB_UART_DIR}/src/*.c)
+    add_library(test_lib_uart_stats STATIC EXCLUDE_FROM_ALL)
+    target_sources(test_lib_uart_stats PRIVATE ${LIB_UART_STATS_SOURCES})
+    target_include_directories(test_lib_uart_stats PUBLIC ${LIB_UART_DIR}/api ${LIB_UART_DIR}/src)
+    target_compile_definitions(test_lib_uart_stats PUBLIC UART_STATS_ENABLED=1)
+    target_compile_options(test_lib_uart_stats PRIVATE -Os)
+    unset(LIB_UART_DIR)
+    unset(LIB_UART_STATS_SOURCES)
+endif()
+
+
+#**********************
+# Setup targets
+#**********************
+foreach(feature ${TEST_RX_FEATURES})
+    set(TARGET_NAME "test_hil_uart_rx_features_test_${feature}")
+    add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL)
+    target_sources(${TARGET_NAME} PUBLIC ${APP_COMMON_SOURCES} ${CMAKE_CURRENT_LIST_DIR}/src/rx_${feature}.c)
+    target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+    target_compile_definitions(${TARGET_NAME} PRIVATE ${APP_COMPILE_DEFINITIONS})
+    target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+    target_link_libraries(${TARGET_NAME} PUBLIC lib_uart framework_core_utils)
+    target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
+    set_target_properties(${TARGET_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/bin)
+    unset(TARGET_NAME)
+endforeach()
+
+foreach(feature ${TEST_RX_STATS_FEATURES})
+    set(TARGET_NAME "test_hil_uart_rx_features_test_${feature}")
+    add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL)
+    target_sources(${TARGET_NAME} PUBLIC ${APP_COMMON_SOURCES} ${CMAKE_CURRENT_LIST_DIR}/src/rx_${feature}.c)
+    target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+    target_compile_definitions(${TARGET_NAME} PRIVATE ${APP_COMPILE_DEFINITIONS})
+    target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+    target_link_libraries(${TARGET_NAME} PUBLIC test_lib_uart_stats framework_core_utils)
+    target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
+    set_target_properties(${TARGET_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/bin)
+    unset(TARGET_NAME)
+endforeach()
@@ -25,7 +25,7 @@ else()
     set(TEST_USE_BUFFERED $ENV{TEST_USE_BUFFERED})
 endif()
 if(NOT DEFINED ENV{TEST_BAUD})
-    set(TEST_BAUD 1843200 1152000 576000 115200 9600)
+    set(TEST_BAUD 1843200 1152000 576000 115200 9600 2400)
 else()
     set(TEST_BAUD $ENV{TEST_BAUD})
 endif()
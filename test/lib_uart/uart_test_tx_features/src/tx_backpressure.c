@@ -0,0 +1,45 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+//Both runs queue more than the 4 byte buffer holds. uart_tx_wait() blocks
+//until there is space and uart_tx_try() is retried when it reports full, so
+//no byte may be dropped
+#define NUM_WAIT_WORDS  16
+#define NUM_TRY_WORDS   8
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[4 + 1] = {0};
+    unsigned try_full = 0;
+
+    uart_tx_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+
+    for(int i = 0; i < NUM_WAIT_WORDS; i++){
+        uart_tx_wait(&uart, i);
+    }
+    while(!tx_empty);
+    tx_empty = 0;
+
+    for(int i = 0; i < NUM_TRY_WORDS; i++){
+        while(uart_tx_try(&uart, 0x80 + i) == UART_BUFFER_FULL){
+            try_full += 1;
+        }
+    }
+    while(!tx_empty);
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Print after the checker has seen the last frame
+
+    printf("uart_tx_try() reported full: %s\n", try_full ? "True" : "False");
+
+    uart_tx_deinit(&uart);
+    hwtimer_free(tmr);
+    exit(0);
+}
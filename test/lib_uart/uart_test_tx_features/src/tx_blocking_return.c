@@ -0,0 +1,34 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+port_t p_marker = XS1_PORT_1B; //Driven high as uart_tx() returns
+
+//Port timed and timer driven
+static const uint32_t bauds[] = {115200, 2400};
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+
+    port_enable(p_marker);
+    for(int b = 0; b < sizeof(bauds) / sizeof(bauds[0]); b++){
+        port_out(p_marker, 0);
+        uart_tx_blocking_init(&uart, p_uart_tx, bauds[b], 8, UART_PARITY_NONE, 1, tmr);
+        hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 1000); //Idle before the frame
+        uart_tx(&uart, 0x35);
+        port_out(p_marker, 1);
+        uart_tx_deinit(&uart);
+        hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 1000);
+    }
+    port_disable(p_marker);
+
+    hwtimer_free(tmr);
+    exit(0);
+}
@@ -0,0 +1,41 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/clock.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+xclock_t clk_uart_tx = XS1_CLKBLK_1;
+
+//Buffered at 1Mbaud then blocking at 115200, where the bit time is rounded to 50MHz / 434
+static const uint8_t buffered_data[] = {0x55, 0xa3, 0x00, 0xff};
+static const uint8_t blocking_data[] = {0x0f, 0xc3};
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1] = {0};
+
+    uart_tx_clocked_init(&uart, p_uart_tx, clk_uart_tx, 1000000, 8, UART_PARITY_NONE, 1, tmr,
+                        buffer, sizeof(buffer), tx_callback, &uart);
+    for(int i = 0; i < sizeof(buffered_data); i++){
+        uart_tx(&uart, buffered_data[i]);
+    }
+    while(!tx_empty);
+    uart_tx_deinit(&uart);
+
+    uart_tx_clocked_init(&uart, p_uart_tx, clk_uart_tx, 115200, 8, UART_PARITY_NONE, 1, 0,
+                        NULL, 0, NULL, NULL);
+    for(int i = 0; i < sizeof(blocking_data); i++){
+        uart_tx(&uart, blocking_data[i]);
+    }
+    uart_tx_deinit(&uart);
+
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Let the checker see the last stop bit
+    hwtimer_free(tmr);
+    exit(0);
+}
@@ -0,0 +1,42 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+//A 4 byte buffer so some of the buffered packet is dropped, which must not be in its CRC
+static const uint8_t packet[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x01};
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[4 + 1] = {0};
+    uart_crc_t crc;
+    uart_crc_init_preset(&crc, UART_CRC_16_MODBUS);
+
+    uart_tx_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+    uart_tx_set_crc(&uart, &crc);
+    for(int i = 0; i < sizeof(packet); i++){
+        uart_tx(&uart, packet[i]);
+    }
+    uart_tx_send_crc(&uart);
+    while(!tx_empty);
+    uart_tx_deinit(&uart);
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Idle between the bursts
+
+    uart_tx_blocking_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr);
+    uart_tx_set_crc(&uart, &crc);
+    for(int i = 0; i < sizeof(packet); i++){
+        uart_tx(&uart, packet[i]);
+    }
+    uart_tx_send_crc(&uart);
+    uart_tx_deinit(&uart);
+
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Let the checker see the end of the last burst
+    hwtimer_free(tmr);
+    exit(0);
+}
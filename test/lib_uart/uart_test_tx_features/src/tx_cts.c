@@ -0,0 +1,31 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+//The checker deasserts CTS during one frame and asserts it again later
+static const uint8_t data[] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+
+port_t p_uart_cts = XS1_PORT_1B;
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[16 + 1] = {0};
+
+    uart_tx_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+    uart_tx_set_cts(&uart, p_uart_cts);
+
+    uart_tx_write(&uart, data, sizeof(data));
+    while(!tx_empty);
+
+    uart_tx_deinit(&uart);
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Let the checker see the last stop bit
+    hwtimer_free(tmr);
+    exit(0);
+}
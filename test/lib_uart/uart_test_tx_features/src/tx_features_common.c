@@ -0,0 +1,36 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <xcore/parallel.h>
+#include <xcore/port.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+port_t p_uart_tx = XS1_PORT_1A;
+
+volatile unsigned tx_empty = 0;
+
+HIL_UART_TX_CALLBACK_ATTR void tx_callback(void *app_data){
+        tx_empty = 1;
+}
+
+DECLARE_JOB(burn, (void));
+
+void burn(void) {
+    for(;;);
+}
+
+//One thread is left for tests that run jobs of their own
+int main(void) {
+    PAR_JOBS (
+        PJOB(INTERRUPT_PERMITTED(test), ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ()),
+        PJOB(burn, ())
+    );
+    return 0;
+}
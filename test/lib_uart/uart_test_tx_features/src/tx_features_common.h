@@ -0,0 +1,17 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#pragma once
+
+#include <xcore/port.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+
+extern port_t p_uart_tx;
+
+extern volatile unsigned tx_empty;
+
+HIL_UART_TX_CALLBACK_ATTR void tx_callback(void *app_data);
+
+//Defined by each feature test
+DECLARE_INTERRUPT_PERMITTED(void, test, void);
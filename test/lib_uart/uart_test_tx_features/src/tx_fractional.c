@@ -0,0 +1,31 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "uart_define.h"
+#include "tx_features_common.h"
+
+//At 3Mbaud the bit time is 33.33 ticks, so truncating it would make every
+//frame 1% short. The blocking 8N1 UART is specialised so it keeps up
+#define NUM_TX_WORDS    16
+
+UART_TX_DEFINE(uart_tx_8n1, 8, NONE, 1, BLOCKING)
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+
+    uart_tx_8n1_init(&uart, p_uart_tx, 3000000, tmr);
+    for(int i = 0; i < NUM_TX_WORDS; i++){
+        uart_tx_8n1_tx(&uart, 0x55);
+    }
+    uart_tx_deinit(&uart);
+
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 1000);
+    hwtimer_free(tmr);
+    exit(0);
+}
@@ -0,0 +1,65 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/parallel.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+//Three lines on one 4b port with different amounts to send, bit 2 is left unused
+#define NUM_LINES       3
+
+port_t p_uart_tx_multi = XS1_PORT_4C;
+
+static const unsigned lines[NUM_LINES] = {0, 1, 3};
+static const uint8_t line_data[NUM_LINES][4] = {
+    {0x00, 0x5a, 0xff, 0xa5},
+    {0x55, 0xc3},
+    {0x80, 0x7e, 0x11},
+};
+static const size_t line_len[NUM_LINES] = {4, 2, 3};
+
+volatile unsigned line_empty[UART_TX_MULTI_MAX_LINES] = {0};
+
+HIL_UART_TX_CALLBACK_ATTR void tx_multi_callback(void *app_data){
+    *(volatile unsigned *)app_data = 1;
+}
+
+DECLARE_JOB(uart_tx_multi, (uart_tx_multi_t *));
+DECLARE_JOB(writer, (uart_tx_multi_t *));
+
+void writer(uart_tx_multi_t *ctx){
+    hwtimer_t tmr = hwtimer_alloc();
+
+    for(int i = 0; i < NUM_LINES; i++){
+        for(int j = 0; j < line_len[i]; j++){
+            uart_tx_multi_write(ctx, lines[i], line_data[i][j]);
+        }
+    }
+    for(int i = 0; i < NUM_LINES; i++){
+        while(!line_empty[lines[i]]);
+    }
+
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 30000); //Longer than the checker waits to see the port idle
+    hwtimer_free(tmr);
+    exit(0);
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_multi_t ctx;
+    uint8_t buffers[NUM_LINES][16 + 1];
+
+    uart_tx_multi_init(&ctx, p_uart_tx_multi, 4, 115200);
+    for(int i = 0; i < NUM_LINES; i++){
+        uart_tx_multi_line_init(&ctx, lines[i], 8, UART_PARITY_NONE, 1,
+                        buffers[i], sizeof(buffers[i]), tx_multi_callback, (void *)&line_empty[lines[i]]);
+    }
+
+    PAR_JOBS (
+        PJOB(uart_tx_multi, (&ctx)),
+        PJOB(writer, (&ctx))
+    );
+}
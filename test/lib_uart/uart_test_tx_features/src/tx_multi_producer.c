@@ -0,0 +1,50 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/lock.h>
+#include <xcore/parallel.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+#define MESSAGE_LEN     4
+#define NUM_MESSAGES    2 //Per producer, must match the checker
+
+DECLARE_JOB(producer, (uart_tx_t *, uint8_t));
+
+void producer(uart_tx_t *uart, uint8_t base){
+    uint8_t message[MESSAGE_LEN];
+    for(int i = 0; i < MESSAGE_LEN; i++){
+        message[i] = base + i;
+    }
+    for(int n = 0; n < NUM_MESSAGES; n++){
+        while(uart_tx_write_message(uart, message, sizeof(message)) != UART_BUFFER_OK);
+    }
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1] = {0};
+    lock_t lock = lock_alloc();
+
+    uart_tx_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+    uart_tx_set_multi_producer(&uart, lock);
+
+    //One producer runs on this thread alongside the ISR and the other on its own
+    PAR_JOBS(
+        PJOB(producer, (&uart, 0xa0)),
+        PJOB(producer, (&uart, 0xb0))
+    );
+
+    //All messages are queued long before the first has been sent
+    while(!tx_empty);
+
+    uart_tx_deinit(&uart);
+    lock_free(lock);
+    hwtimer_free(tmr);
+    exit(0);
+}
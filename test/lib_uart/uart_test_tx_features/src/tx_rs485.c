@@ -0,0 +1,57 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+#define DE_LEAD_TICKS   500 //5us, must match the checker
+
+port_t p_uart_de = XS1_PORT_1B;
+
+//Port timed, port timed with a bit time beyond a quarter of the port timer and timer driven
+typedef struct {
+    uint32_t baud;
+    int buffered;
+    uint8_t data[2];
+    size_t len;
+} rs485_run_t;
+
+static const rs485_run_t runs[] = {
+    {115200, 1, {0x55, 0xa3}, 2},
+    {4800,   1, {0x0f},       1},
+    {2400,   0, {0xc3},       1},
+};
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[64 + 1] = {0};
+
+    for(int r = 0; r < sizeof(runs) / sizeof(runs[0]); r++){
+        const rs485_run_t *run = &runs[r];
+        tx_empty = 0;
+        if(run->buffered){
+            uart_tx_init(&uart, p_uart_tx, run->baud, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+        } else {
+            uart_tx_blocking_init(&uart, p_uart_tx, run->baud, 8, UART_PARITY_NONE, 1, tmr);
+        }
+        uart_tx_set_rs485(&uart, p_uart_de, DE_LEAD_TICKS);
+
+        for(int i = 0; i < run->len; i++){
+            uart_tx(&uart, run->data[i]);
+        }
+        if(run->buffered){
+            while(!tx_empty);
+        }
+
+        uart_tx_deinit(&uart); //Waits for DE to be released
+    }
+
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Let the checker see the last release
+    hwtimer_free(tmr);
+    exit(0);
+}
@@ -0,0 +1,52 @@
+// Copyright 2022 XMOS LIMITED.
+// This Software is subject to the terms of the XMOS Public Licence: Version 1.
+#include <xs1.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <xcore/hwtimer.h>
+#include <xcore/interrupt_wrappers.h>
+
+#include "uart.h"
+#include "tx_features_common.h"
+
+//An 8 byte buffer is topped up each time it falls below the low watermark,
+//so NUM_TX_WORDS are sent back to back with 3 refills after the first fill
+#define LOW_WATERMARK   3
+#define NUM_TX_WORDS    24
+
+volatile unsigned refill_needed = 0;
+
+HIL_UART_TX_CALLBACK_ATTR void low_watermark_callback(void *app_data){
+    refill_needed = 1;
+}
+
+DEFINE_INTERRUPT_PERMITTED(UART_TX_INTERRUPTABLE_FUNCTIONS, void, test, void){
+    uart_tx_t uart;
+    hwtimer_t tmr = hwtimer_alloc();
+    uint8_t buffer[8 + 1] = {0};
+    uint8_t data[NUM_TX_WORDS];
+    unsigned refills = 0;
+
+    for(int i = 0; i < NUM_TX_WORDS; i++){
+        data[i] = i * 0x11 + 1;
+    }
+
+    uart_tx_init(&uart, p_uart_tx, 115200, 8, UART_PARITY_NONE, 1, tmr, buffer, sizeof(buffer), tx_callback, &uart);
+    uart_tx_set_low_watermark(&uart, LOW_WATERMARK, low_watermark_callback);
+
+    size_t sent = uart_tx_write(&uart, data, NUM_TX_WORDS);
+    while(sent < NUM_TX_WORDS){
+        while(!refill_needed);
+        refill_needed = 0;
+        sent += uart_tx_write(&uart, &data[sent], NUM_TX_WORDS - sent);
+        refills += 1;
+    }
+    while(!tx_empty);
+    hwtimer_wait_until(tmr, hwtimer_get_time(tmr) + 10000); //Print after the checker has seen the last frame
+
+    printf("refills: %u\n", refills);
+
+    uart_tx_deinit(&uart);
+    hwtimer_free(tmr);
+    exit(0);
+}
@@ -0,0 +1,44 @@
+#**********************
+# Gather Sources
+#**********************
+# Each feature has its own test() in src/tx_<feature>.c sharing the harness in tx_features_common.c
+set(APP_COMMON_SOURCES ${CMAKE_CURRENT_LIST_DIR}/src/tx_features_common.c)
+set(APP_INCLUDES ${CMAKE_CURRENT_LIST_DIR}/src ${CMAKE_CURRENT_LIST_DIR}/..)
+
+#**********************
+# Flags
+#**********************
+set(APP_COMPILER_FLAGS
+    -Os
+    -target=XCORE-AI-EXPLORER
+)
+set(APP_LINK_OPTIONS
+    -report
+    -target=XCORE-AI-EXPLORER
+)
+
+#**********************
+# Tile Targets
+#**********************
+if(NOT DEFINED ENV{TEST_TX_FEATURES})
+    set(TEST_TX_FEATURES rs485 blocking_return multi_producer crc clocked multi watermark fractional cts backpressure)
+else()
+    set(TEST_TX_FEATURES $ENV{TEST_TX_FEATURES})
+endif()
+
+
+#**********************
+# Setup targets
+#**********************
+foreach(feature ${TEST_TX_FEATURES})
+    set(TARGET_NAME "test_hil_uart_tx_features_test_${feature}")
+    add_executable(${TARGET_NAME} EXCLUDE_FROM_ALL)
+    target_sources(${TARGET_NAME} PUBLIC ${APP_COMMON_SOURCES} ${CMAKE_CURRENT_LIST_DIR}/src/tx_${feature}.c)
+    target_include_directories(${TARGET_NAME} PUBLIC ${APP_INCLUDES})
+    target_compile_definitions(${TARGET_NAME} PRIVATE ${APP_COMPILE_DEFINITIONS})
+    target_compile_options(${TARGET_NAME} PRIVATE ${APP_COMPILER_FLAGS})
+    target_link_libraries(${TARGET_NAME} PUBLIC lib_uart framework_core_utils)
+    target_link_options(${TARGET_NAME} PRIVATE ${APP_LINK_OPTIONS})
+    set_target_properties(${TARGET_NAME} PROPERTIES RUNTIME_OUTPUT_DIRECTORY ${CMAKE_CURRENT_LIST_DIR}/bin)
+    unset(TARGET_NAME)
+endforeach()
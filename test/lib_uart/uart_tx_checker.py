@@ -3,6 +3,7 @@
 import Pyxsim as px
 from typing import Sequence
 from functools import partial
+from bisect import bisect_right
 
 # We need to disable output buffering for this test to work on MacOS; this has
 # no effect on Linux systems. Let's redefine print once to avoid putting the 
@@ -233,6 +234,25 @@ class UARTTxChecker(px.SimThread):
 
         return start_val
 
+    def sample_frame(self, xsi):
+        """
+        Wait for a start bit and read the frame, sampling in the middle of each
+        bit. Parity is not checked.
+
+        Returns (data, start_time, stop_ok).
+        """
+        self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0))
+        start_time = xsi.get_time()
+        bit_time = self.get_bit_time()
+        data = 0
+        for j in range(self._bits_per_byte):
+            self.wait_until(start_time + (1.5 + j) * bit_time)
+            data |= self.get_port_val(xsi, self._tx_port) << j
+        stop_bit = 1 + self._bits_per_byte + (1 if self._parity > 0 else 0)
+        self.wait_until(start_time + (stop_bit + 0.5) * bit_time)
+        stop_ok = self.get_port_val(xsi, self._tx_port) == 1
+        return data, start_time, stop_ok
+
     def run(self):
         # Wait for the xcore to bring the uart tx port up
         self.wait((lambda x: self.xsi.is_port_driving(self._tx_port)))
@@ -244,3 +264,431 @@ class UARTTxChecker(px.SimThread):
         # inline lambda function mapped over a list? awh yiss.
         print(", ".join(map((lambda x: "0x%02x" % ord(x)), K)))
 
+
+
+class UARTDEChecker(UARTTxChecker):
+    """
+    This simulator thread checks the RS-485 driver enable (DE) of a UART Tx
+    as well as the data. DE must rise at least the lead time before the first
+    start bit, stay high across back to back frames and fall at the end of
+    the last stop bit. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, de_port, runs, lead_ps):
+        """
+        Create a UARTDEChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param de_port:    Driver enable port of the UART device under test.
+        :param runs:       List of (baud, length) for each burst sent.
+        :param lead_ps:    Minimum time DE is high before the start bit.
+        """
+        super().__init__(None, tx_port, 0, runs[0][0], runs[0][1], 1, 8)
+        self._de_port = de_port
+        self._runs = runs
+        self._lead_ps = lead_ps
+
+    def get_de_val(self, xsi):
+        """
+        Sample DE, which is low when the port is not driven.
+        """
+        if not xsi.is_port_driving(self._de_port):
+            return 0
+        return xsi.sample_port_pins(self._de_port)
+
+    def read_run(self, xsi, length):
+        """
+        Read one burst of frames, sampling in the middle of each bit, and check
+        DE around it.
+        """
+        self.wait((lambda x: self.get_de_val(xsi) == 1))
+        de_rise_time = xsi.get_time()
+
+        bit_time = self.get_bit_time()
+        frame_end = 0
+        for i in range(length):
+            self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0))
+            start_time = xsi.get_time()
+            if i == 0:
+                print("DE asserted before start bit: %s" % (start_time - de_rise_time >= self._lead_ps))
+
+            byte = 0
+            for j in range(self._bits_per_byte):
+                self.wait_until(start_time + (1.5 + j) * bit_time)
+                byte |= self.get_port_val(xsi, self._tx_port) << j
+            self.wait_until(start_time + (1.5 + self._bits_per_byte) * bit_time)
+            stop_ok = self.get_port_val(xsi, self._tx_port) == 1
+            # Late in the stop bit, where DE must still be driven
+            self.wait_until(start_time + (1.75 + self._bits_per_byte) * bit_time)
+            de_held = self.get_de_val(xsi) == 1
+            frame_end = start_time + (2 + self._bits_per_byte) * bit_time
+            print("0x%02x stop bit correct: %s DE held: %s" % (byte, stop_ok, de_held))
+
+        self.wait((lambda x: self.get_de_val(xsi) == 0))
+        # Allow for the ISR running the release a little late when timer driven
+        error = xsi.get_time() - frame_end
+        print("DE released at end of stop bit: %s" % (-0.02 * bit_time <= error <= 0.05 * bit_time))
+
+    def run(self):
+        xsi = self.xsi
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        for baud, length in self._runs:
+            self._baud = baud
+            self.read_run(xsi, length)
+
+
+class UARTTxReturnChecker(UARTTxChecker):
+    """
+    This simulator thread checks a blocking uart_tx() returns at the end of
+    the stop bit. The app drives a marker port high as uart_tx() returns.
+    Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, marker_port, bauds):
+        """
+        Create a UARTTxReturnChecker instance.
+
+        :param tx_port:     Transmit port of the UART device under test.
+        :param marker_port: Port driven high by the app as uart_tx() returns.
+        :param bauds:       List of baud rates, one frame each.
+        """
+        super().__init__(None, tx_port, 0, bauds[0], 1, 1, 8)
+        self._marker_port = marker_port
+        self._bauds = bauds
+
+    def get_marker_val(self, xsi):
+        if not xsi.is_port_driving(self._marker_port):
+            return 0
+        return xsi.sample_port_pins(self._marker_port)
+
+    def run(self):
+        xsi = self.xsi
+        for baud in self._bauds:
+            self._baud = baud
+            self.wait((lambda x: xsi.is_port_driving(self._tx_port) and self.get_marker_val(xsi) == 0))
+            self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0))
+            start_time = xsi.get_time()
+            self.wait((lambda x: self.get_marker_val(xsi) == 1))
+            # The return must be at the end of the stop bit, allowing for the timer driven
+            # path timing bits from the wake up, and well before another bit time
+            frame_time = xsi.get_time() - start_time
+            bit_time = self.get_bit_time()
+            frame_bits = 1 + self._bits_per_byte + self._stop_bits
+            print("uart_tx() returned at end of frame: %s" %
+                  ((frame_bits - 0.02) * bit_time <= frame_time < (frame_bits + 0.5) * bit_time))
+
+
+class UARTTxMessageChecker(UARTTxChecker):
+    """
+    This simulator thread checks messages from several producers sharing one
+    UART Tx arrive whole, in any order. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, baud, messages):
+        """
+        Create a UARTTxMessageChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param baud:       BAUD rate of the UART connection.
+        :param messages:   List of the messages expected, each a list of bytes.
+        """
+        length = sum(len(m) for m in messages)
+        super().__init__(None, tx_port, 0, baud, length, 1, 8)
+        self._messages = messages
+
+    def run(self):
+        xsi = self.xsi
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        stream = []
+        stop_ok = True
+        for i in range(self._length):
+            data, _, ok = self.sample_frame(xsi)
+            stream.append(data)
+            stop_ok = stop_ok and ok
+        print("Stop bits correct: %s" % stop_ok)
+
+        # Each message must appear whole, so match them off the front of the stream
+        remaining = [list(m) for m in self._messages]
+        whole = True
+        pos = 0
+        while pos < len(stream):
+            for m in remaining:
+                if stream[pos:pos + len(m)] == m:
+                    remaining.remove(m)
+                    pos += len(m)
+                    break
+            else:
+                whole = False
+                break
+        print("Messages received whole: %s" % (whole and not remaining))
+
+
+def crc16_modbus(data):
+    """
+    Returns the Modbus RTU CRC of a list of bytes. It is sent LSB first.
+    """
+    crc = 0xffff
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xa001 if crc & 1 else crc >> 1
+    return crc
+
+
+class UARTTxCRCChecker(UARTTxChecker):
+    """
+    This simulator thread checks bursts of frames each end in the Modbus CRC
+    of the rest of the burst. A burst ends when the line is idle for several
+    bit times. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, baud, bursts):
+        """
+        Create a UARTTxCRCChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param baud:       BAUD rate of the UART connection.
+        :param bursts:     The number of bursts to check.
+        """
+        super().__init__(None, tx_port, 0, baud, 0, 1, 8)
+        self._bursts = bursts
+
+    def run(self):
+        xsi = self.xsi
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        for b in range(self._bursts):
+            burst = []
+            while True:
+                data, _, _ = self.sample_frame(xsi)
+                burst.append(data)
+                # The next start bit, if any, comes within a few bit times
+                deadline = xsi.get_time() + 4 * self.get_bit_time()
+                self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0 or xsi.get_time() >= deadline))
+                if self.get_port_val(xsi, self._tx_port) == 1:
+                    break
+            crc = crc16_modbus(burst[:-2])
+            print("burst %d: %d bytes CRC correct: %s" %
+                  (b, len(burst), len(burst) > 2 and burst[-2:] == [crc & 0xff, crc >> 8]))
+
+
+class UARTLoopbackRateChecker(UARTTxChecker):
+    """
+    This simulator thread loops a UART Tx pin back to a UART Rx pin and
+    measures the bit rate of the first burst sent. The burst must be
+    back to back 8N1 frames of 0x55, so the line toggles every bit.
+    """
+
+    def __init__(self, tx_port, rx_port, baud, num_frames):
+        """
+        Create a UARTLoopbackRateChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param rx_port:    Receive port of the UART device under test.
+        :param baud:       Expected BAUD rate.
+        :param num_frames: The number of frames in the burst measured.
+        """
+        super().__init__(rx_port, tx_port, 0, baud, num_frames, 1, 8)
+
+    def report(self, edges):
+        bit_time = self.get_bit_time()
+        measured = (edges[-1] - edges[0]) / (len(edges) - 1)
+        longest = max(b - a for a, b in zip(edges, edges[1:]))
+        print("Interesting stats: measured %d baud" % round(1e12 / measured))
+        print("bit time within 1%%: %s" % (abs(measured - bit_time) <= 0.01 * bit_time))
+        print("frames back to back: %s" % (longest < 1.5 * bit_time))
+
+    def run(self):
+        xsi = self.xsi
+        level = 1
+        xsi.drive_port_pins(self._rx_port, level)
+        # Every bit boundary of the burst is an edge, from the first start bit to the last stop bit
+        num_edges = self._length * (2 + self._bits_per_byte)
+        edges = []
+        while True:
+            self.wait_for_port_pins_change([self._tx_port])
+            val = self.get_port_val(xsi, self._tx_port)
+            if val == level:
+                continue
+            level = val
+            xsi.drive_port_pins(self._rx_port, level)
+            if len(edges) < num_edges:
+                edges.append(xsi.get_time())
+                if len(edges) == num_edges:
+                    self.report(edges)
+
+
+class UARTTxRunChecker(UARTTxChecker):
+    """
+    This simulator thread reads several runs of frames, each at its own baud
+    rate, sampling in the middle of each bit. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, runs):
+        """
+        Create a UARTTxRunChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param runs:       List of (baud, length) for each run sent.
+        """
+        super().__init__(None, tx_port, 0, runs[0][0], runs[0][1], 1, 8)
+        self._runs = runs
+
+    def run(self):
+        xsi = self.xsi
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        for baud, length in self._runs:
+            self._baud = baud
+            for i in range(length):
+                data, _, stop_ok = self.sample_frame(xsi)
+                print("0x%02x stop bit correct: %s" % (data, stop_ok))
+
+
+class UARTTxMultiChecker(UARTTxChecker):
+    """
+    This simulator thread checks several UART Tx lines, each on its own bit of
+    one port and sharing one baud rate. The port is recorded until it has
+    been idle for a while after the first frame, then the frames of each line
+    are read from the recording. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, baud, lines):
+        """
+        Create a UARTTxMultiChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param baud:       BAUD rate of all lines.
+        :param lines:      List of (bit, length) for each line checked.
+        """
+        super().__init__(None, tx_port, 0, baud, 0, 1, 8)
+        self._lines = lines
+
+    def record(self, xsi):
+        """
+        Returns a list of (time, port value) for each change of the port.
+        """
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        changes = [(xsi.get_time(), xsi.sample_port_pins(self._tx_port))]
+        idle_time = 20 * self.get_bit_time()
+        while True:
+            last = changes[-1][1]
+            deadline = changes[-1][0] + idle_time if len(changes) > 1 else None
+            self.wait((lambda x: xsi.sample_port_pins(self._tx_port) != last or
+                       (deadline is not None and xsi.get_time() >= deadline)))
+            val = xsi.sample_port_pins(self._tx_port)
+            if val == last:
+                return changes
+            changes.append((xsi.get_time(), val))
+
+    def run(self):
+        xsi = self.xsi
+        changes = self.record(xsi)
+        times = [t for t, v in changes]
+        bit_time = self.get_bit_time()
+
+        def pin(t, bit):
+            return (changes[bisect_right(times, t) - 1][1] >> bit) & 1
+
+        for bit, length in self._lines:
+            # Each start bit is a falling edge of this line
+            t = times[0]
+            for i in range(length):
+                falls = [ct for ct, prev, cur in zip(times[1:], changes, changes[1:])
+                         if ct > t and (prev[1] >> bit) & 1 and not (cur[1] >> bit) & 1]
+                if not falls:
+                    print("line %d: frame missing" % bit)
+                    break
+                start_time = falls[0]
+                data = 0
+                for j in range(self._bits_per_byte):
+                    data |= pin(start_time + (1.5 + j) * bit_time, bit) << j
+                stop_ok = pin(start_time + (1.5 + self._bits_per_byte) * bit_time, bit) == 1
+                print("line %d: 0x%02x stop bit correct: %s" % (bit, data, stop_ok))
+                t = start_time + (1 + self._bits_per_byte) * bit_time
+
+
+class UARTTxRateChecker(UARTTxChecker):
+    """
+    This simulator thread measures the bit rate within frames of 0x55, where
+    the line toggles every bit. Each frame is timed from the start of the
+    start bit to the start of the stop bit, so gaps between frames do not
+    count. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, baud, num_frames, tolerance):
+        """
+        Create a UARTTxRateChecker instance.
+
+        :param tx_port:    Transmit port of the UART device under test.
+        :param baud:       Expected BAUD rate.
+        :param num_frames: The number of frames measured.
+        :param tolerance:  The largest error in the mean bit time allowed, as
+                           a fraction of the bit time.
+        """
+        super().__init__(None, tx_port, 0, baud, num_frames, 1, 8)
+        self._tolerance = tolerance
+
+    def run(self):
+        xsi = self.xsi
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 1))
+        # From the start bit to the stop bit there is an edge at every bit boundary
+        spans = []
+        for i in range(self._length):
+            self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0))
+            start_time = xsi.get_time()
+            for j in range(1 + self._bits_per_byte):
+                self.wait_for_port_pins_change([self._tx_port])
+            spans.append(xsi.get_time() - start_time)
+
+        bit_time = self.get_bit_time()
+        measured = sum(spans) / (len(spans) * (1 + self._bits_per_byte))
+        print("Interesting stats: measured %d baud" % round(1e12 / measured))
+        print("bit time within %g%%: %s" % (100 * self._tolerance, abs(measured - bit_time) <= self._tolerance * bit_time))
+
+
+class UARTTxCTSChecker(UARTTxChecker):
+    """
+    This simulator thread drives CTS of a UART Tx. CTS is deasserted during
+    one frame, which must complete, then no frame may start until CTS is
+    asserted again. Frames are 8N1.
+    """
+
+    def __init__(self, tx_port, cts_port, baud, length, pause_frame, pause_bits):
+        """
+        Create a UARTTxCTSChecker instance.
+
+        :param tx_port:     Transmit port of the UART device under test.
+        :param cts_port:    CTS port of the UART device under test.
+        :param baud:        BAUD rate of the UART connection.
+        :param length:      The number of frames expected.
+        :param pause_frame: The index of the frame during which CTS is deasserted.
+        :param pause_bits:  How long CTS is deasserted for after that frame, in bit times.
+        """
+        super().__init__(None, tx_port, 0, baud, length, 1, 8)
+        self._cts_port = cts_port
+        self._pause_frame = pause_frame
+        self._pause_bits = pause_bits
+
+    def run(self):
+        xsi = self.xsi
+        xsi.drive_port_pins(self._cts_port, 0)
+        self.wait((lambda x: xsi.is_port_driving(self._tx_port)))
+        bit_time = self.get_bit_time()
+        for i in range(self._length):
+            self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0))
+            start_time = xsi.get_time()
+            data = 0
+            for j in range(self._bits_per_byte):
+                self.wait_until(start_time + (1.5 + j) * bit_time)
+                data |= self.get_port_val(xsi, self._tx_port) << j
+                if i == self._pause_frame and j == 0:
+                    xsi.drive_port_pins(self._cts_port, 1)
+            self.wait_until(start_time + (1.5 + self._bits_per_byte) * bit_time)
+            stop_ok = self.get_port_val(xsi, self._tx_port) == 1
+            print("0x%02x stop bit correct: %s" % (data, stop_ok))
+
+            if i == self._pause_frame:
+                deadline = xsi.get_time() + self._pause_bits * bit_time
+                self.wait((lambda x: self.get_port_val(xsi, self._tx_port) == 0 or xsi.get_time() >= deadline))
+                print("Tx paused while CTS deasserted: %s" % (self.get_port_val(xsi, self._tx_port) == 1))
+                xsi.drive_port_pins(self._cts_port, 0)